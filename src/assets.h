@@ -4,7 +4,6 @@
 #include "types.h"
 #include <string>
 #include <optional>
-#include "glw.h"
 #include <stb_image.h>
 
 namespace game::assets
@@ -0,0 +1,265 @@
+#include "game.h"
+#include "tick.h"
+#include "hitboxes.h"
+#include "carbatch.h"
+#include "histogram.h"
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <memory>
+#include <cmath>
+#include <random>
+
+// microbenchmarks for the simulation's hot paths, run from the repository root so the track can be loaded
+// prints one json object per line: the mean ns/op and ops/s, and the percentiles of the time each op took on its own
+namespace
+{
+	using namespace game;
+
+	constexpr u32 Samples = 50;
+	constexpr f64 SampleLength = 0.01; // seconds
+
+	volatile u64 s_sink = 0; // stops results being optimised away
+
+	// results go here, std::cout is silenced so the race messages don't end up in them
+	std::ostream s_out(std::cout.rdbuf());
+
+	// drives in circles, so every tick does the full physics model
+	class BenchCar : public Car
+	{
+	public:
+		explicit BenchCar(glm::dvec2 position) : Car(position) {}
+
+		void updateInputs(u64 tick) override
+		{
+			m_inputs[Accelerate] = true;
+			m_inputs[Left] = (tick / 64) % 2 == 0;
+		}
+	};
+
+	using Clock = std::chrono::steady_clock;
+
+	// what timing a single op adds on top of the op, taken off the percentiles
+	[[nodiscard]] f64 timerOverhead()
+	{
+		static const auto overhead = []()
+		{
+			util::Histogram times;
+
+			for(u32 i = 0; i < 100000; ++i)
+			{
+				const auto start = Clock::now();
+				times.record(std::chrono::duration<f64>(Clock::now() - start).count());
+			}
+
+			return times.percentile(0.5) * 1e9;
+		}();
+
+		return overhead;
+	}
+
+	// runs op in batches sized to take about SampleLength each for the mean time per op, then up to as many again
+	// timed one at a time for the percentiles, so a slow op isn't averaged away into its batch
+	template <typename Op>
+	void bench(const std::string &filter, const std::string &name, Op &&op)
+	{
+		if(!filter.empty() && name.find(filter) == std::string::npos) return;
+
+		const auto timeBatch = [&op](u64 ops)
+		{
+			const auto start = Clock::now();
+			for(u64 i = 0; i < ops; ++i) op();
+			return std::chrono::duration<f64>(Clock::now() - start).count();
+		};
+
+		// warm up and find a batch size
+		u64 batch = 1;
+		while(timeBatch(batch) < SampleLength / 4.0 && batch < (u64 { 1 } << 30)) batch *= 2;
+		batch *= 4;
+
+		f64 total = 0.0;
+		for(u32 i = 0; i < Samples; ++i) total += timeBatch(batch);
+
+		const auto ops = batch * Samples;
+		const auto mean = total * 1e9 / static_cast<f64>(ops);
+
+		util::Histogram times;
+		f64 fastest = INFINITY;
+
+		// timing an op costs more than a fast op does, so this stops after as long as the batches took
+		const auto end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<f64>(total));
+
+		for(u64 i = 0; i < ops; ++i)
+		{
+			const auto start = Clock::now();
+			if(start > end) break;
+
+			op();
+			const auto time = std::chrono::duration<f64>(Clock::now() - start).count();
+
+			times.record(time);
+			fastest = std::min(fastest, time);
+		}
+
+		const auto ns = [](f64 seconds) { return std::max(seconds * 1e9 - timerOverhead(), 0.0); };
+
+		s_out << "{\"name\":\"" << name << "\",\"ops\":" << ops
+				  << ",\"ns_per_op\":" << mean << ",\"ops_per_s\":" << 1e9 / mean
+				  << ",\"p50\":" << ns(times.percentile(0.5)) << ",\"p90\":" << ns(times.percentile(0.9))
+				  << ",\"p99\":" << ns(times.percentile(0.99)) << ",\"min\":" << ns(fastest)
+				  << ",\"max\":" << ns(times.max()) << '}' << std::endl;
+	}
+
+	void benchObb(const std::string &filter)
+	{
+		const util::OrientedBoundingBox box({ 0.0, 0.0 }, 0.0, { 2.0, 1.0 });
+		const util::OrientedBoundingBox rotatedBox({ 0.0, 0.0 }, 0.6, { 2.1, 1.3 });
+
+		const std::vector<std::pair<std::string, util::OrientedBoundingBox>> cases {
+			{ "obb_intersects/aligned_hit", { { 0.5, 0.5 }, 0.0, { 2.0, 1.0 } } },
+			{ "obb_intersects/aligned_miss", { { 5.0, 0.0 }, 0.0, { 2.0, 1.0 } } },
+			{ "obb_intersects/rotated_hit", { { 0.8, 0.3 }, 1.1, { 2.1, 1.3 } } },
+			{ "obb_intersects/rotated_miss", { { 4.0, 4.0 }, 1.1, { 2.1, 1.3 } } }
+		};
+
+		for(const auto &[name, other] : cases)
+		{
+			const auto &self = other.m_rotation == 0.0 ? box : rotatedBox;
+			bench(filter, name, [&self, &other]() { s_sink = s_sink + self.intersects(other); });
+		}
+	}
+
+	void benchTrack(const std::string &filter, const Track &track)
+	{
+		// a car sitting on the grid touches nothing, one moved onto the first wall touches it
+		const util::OrientedBoundingBox miss({ -28.7, 2.0 }, util::toRad(90.0), { 2.1, 1.3 });
+		const util::OrientedBoundingBox hit(track.hitboxes().front().m_position, util::toRad(90.0), { 2.1, 1.3 });
+
+		bench(filter, "track_intersects/miss", [&track, &miss]() { s_sink = s_sink + track.intersects(miss); });
+		bench(filter, "track_intersects/hit", [&track, &hit]() { s_sink = s_sink + track.intersects(hit); });
+
+		// the whole track without the grid, to compare the batched kernel with one box at a time
+		util::HitboxStore store;
+		for(const auto &box : track.hitboxes()) store.add(box);
+
+		bench(filter, "hitbox_store/simd_miss", [&store, &miss]() { s_sink = s_sink + store.anyIntersects(miss); });
+		bench(filter, "hitbox_store/scalar_miss", [&store, &miss]() { s_sink = s_sink + store.anyIntersectsScalar(miss, 0, store.size()); });
+
+		bench(filter, "track_construct", []() { s_sink = s_sink + Track().hitboxes().size(); });
+
+		const Track sdfTrack(TrackCollision::DistanceField);
+
+		bench(filter, "track_intersects/sdf_miss", [&sdfTrack, &miss]() { s_sink = s_sink + sdfTrack.intersects(miss); });
+		bench(filter, "track_intersects/sdf_hit", [&sdfTrack, &hit]() { s_sink = s_sink + sdfTrack.intersects(hit); });
+		bench(filter, "track_construct/sdf", []() { s_sink = s_sink + (Track(TrackCollision::DistanceField).wallDistance({ 0.0, 0.0 }).m_distance > 0.0); });
+
+		const Track bvhTrack(TrackCollision::Bvh);
+
+		bench(filter, "track_intersects/bvh_miss", [&bvhTrack, &miss]() { s_sink = s_sink + bvhTrack.intersects(miss); });
+		bench(filter, "track_intersects/bvh_hit", [&bvhTrack, &hit]() { s_sink = s_sink + bvhTrack.intersects(hit); });
+		bench(filter, "track_construct/bvh", []() { s_sink = s_sink + Track(TrackCollision::Bvh).hitboxes().size(); });
+	}
+
+	// rotated barriers from small cones to long walls scattered over the track, which a fixed cell size suits badly
+	void benchBarriers(const std::string &filter)
+	{
+		std::mt19937 random(1);
+		std::uniform_real_distribution<f64> x(-32.0, 32.0), y(-18.0, 18.0), angle(0.0, 3.2), length(0.2, 12.0);
+
+		std::vector<util::OrientedBoundingBox> barriers;
+		for(u32 i = 0; i < 300; ++i) barriers.emplace_back(glm::dvec2 { x(random), y(random) }, angle(random), glm::dvec2 { length(random), 0.3 });
+
+		std::vector<util::OrientedBoundingBox> queries;
+		for(u32 i = 0; i < 256; ++i) queries.emplace_back(glm::dvec2 { x(random), y(random) }, angle(random), glm::dvec2 { 2.1, 1.3 });
+
+		for(const auto &[name, collision] : { std::pair { "grid", TrackCollision::Hitboxes }, std::pair { "bvh", TrackCollision::Bvh } })
+		{
+			Track track(collision);
+			track.addColliders(barriers);
+
+			u32 query = 0;
+			bench(filter, std::string("barriers_intersects/") + name, [&track, &queries, &query]() { s_sink = s_sink + track.intersects(queries[query++ % queries.size()]); });
+		}
+	}
+
+	// columns of cars behind the starting line, 2 is the normal grid
+	void benchCarTick(const std::string &filter, const std::string &name, const std::shared_ptr<Track> &track, u32 cars, u32 threads, u32 substeps = 1, u32 columns = 2)
+	{
+		World world(cars, threads, substeps);
+		world.addEntity(track);
+
+		for(u32 i = 0; i < cars; ++i)
+		{
+			world.addEntity(std::make_shared<BenchCar>(glm::dvec2 { -28.7 + 2.2 * static_cast<f64>(i % columns), 2.0 - 3.0 * static_cast<f64>(i / columns) }));
+		}
+
+		u64 tick = 0;
+		bench(filter, name, [&world, &tick]() { world.tick(TickLength, tick++); });
+	}
+
+	void benchCarTick(const std::string &filter, const std::shared_ptr<Track> &track)
+	{
+		for(u32 cars : { 1U, 4U, 16U, 64U, 256U }) benchCarTick(filter, "car_tick/cars=" + std::to_string(cars), track, cars, 1);
+
+		// what more accurate physics costs, each step should take about as long as a whole tick with 1
+		for(u32 substeps : { 2U, 4U, 8U }) benchCarTick(filter, "car_tick/cars=64/substeps=" + std::to_string(substeps), track, 64, 1, substeps);
+
+		// a 64 by 64 block split between threads, integrating and finding neighbours are split up but the broadphase update,
+		// resolving pairs and finishing laps run in car order on one thread, about a third of a tick with 1 thread,
+		// so this stops getting faster at around 3 times as fast however many threads there are
+		for(u32 threads : { 1U, 2U, 4U, 8U, 16U, 32U }) benchCarTick(filter, "car_tick/cars=4096/threads=" + std::to_string(threads), track, 4096, threads, 1, 64);
+	}
+
+	// the same cars and inputs as car_tick, without car against car collision
+	template <typename Batch>
+	void benchCarBatch(const std::string &filter, const std::string &name, const Track &track, u32 spec = 0)
+	{
+		for(u32 cars : { 1U, 16U, 256U, 4096U })
+		{
+			Batch batch(spec);
+			batch.reserve(cars);
+
+			for(u32 i = 0; i < cars; ++i) batch.add(glm::dvec2 { i % 2 == 0 ? -28.7 : -26.5, 2.0 - 3.0 * static_cast<f64>(i / 2) });
+
+			u64 tick = 0;
+			bench(filter, name + "/cars=" + std::to_string(cars), [&batch, &track, &tick]()
+			{
+				const auto bits = static_cast<u8>(1 << Car::Accelerate | ((tick / 64) % 2 == 0 ? 1 << Car::Left : 0));
+				for(u32 i = 0; i < batch.size(); ++i) batch.setInputs(i, bits);
+
+				batch.tick(track, TickLength);
+				++tick;
+			});
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const std::string filter = argc > 1 ? argv[1] : "";
+
+	std::cout.rdbuf(nullptr);
+
+	const auto track = std::make_shared<Track>();
+
+	if(track->hitboxes().empty())
+	{
+		std::cerr << "no track hitboxes, run from the directory containing assets/" << std::endl;
+		return 1;
+	}
+
+	benchObb(filter);
+	benchTrack(filter, *track);
+	benchBarriers(filter);
+	benchCarTick(filter, track);
+	benchCarBatch<CarBatch>(filter, "car_batch", *track);
+	benchCarBatch<CarBatch32>(filter, "car_batch32", *track);
+	benchCarBatch<FixedCarBatch>(filter, "car_batch_fixed", *track);
+
+	// the other specs, each runs its own instantiation of the model
+	for(u32 spec = 1; spec < physics::CarSpecs.size(); ++spec) benchCarBatch<CarBatch>(filter, std::string("car_batch_") + physics::CarSpecs[spec]->m_name, *track, spec);
+
+	return 0;
+}
@@ -0,0 +1,173 @@
+#include "bitmap.h"
+#include <algorithm>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace game::util
+{
+	namespace
+	{
+		constexpr u32 ParallelPixels = 1 << 20; // smaller images aren't worth starting threads for
+
+		// x must not be 0
+		inline u32 countTrailingZeros(u64 x)
+		{
+#if defined(_MSC_VER)
+			unsigned long index;
+			_BitScanForward64(&index, x);
+			return static_cast<u32>(index);
+#else
+			return static_cast<u32>(__builtin_ctzll(x));
+#endif
+		}
+
+		// count bits starting at bit first, count must be 1 to 64 - first
+		inline u64 bitRange(u32 first, u32 count)
+		{
+			return (count == 64 ? ~u64 { 0 } : (u64 { 1 } << count) - 1) << first;
+		}
+	}
+
+	RowBitmap::RowBitmap(u32 width, u32 height)
+		: m_width(width), m_height(height),
+		  m_rowWords((width + 63) / 64),
+		  m_words(static_cast<size_t>(m_rowWords) * height, 0) {}
+
+	RowBitmap RowBitmap::fromAlpha(const u32 *pixels, u32 width, u32 height)
+	{
+		RowBitmap bitmap(width, height);
+
+		const auto packRows = [&bitmap, pixels, width](u32 begin, u32 end)
+		{
+			for(u32 y = begin; y < end; ++y)
+			{
+				const auto *rowPixels = pixels + static_cast<size_t>(y) * width;
+				auto *row = bitmap.m_words.data() + static_cast<size_t>(y) * bitmap.m_rowWords;
+
+				for(u32 word = 0; word < bitmap.m_rowWords; ++word)
+				{
+					const auto first = word * 64;
+					const auto count = std::min(64U, width - first);
+
+					u64 bits = 0;
+
+					for(u32 i = 0; i < count; ++i) bits |= static_cast<u64>((rowPixels[first + i] >> 24) != 0) << i;
+
+					row[word] = bits;
+				}
+			}
+		};
+
+		const auto threads = static_cast<u32>(static_cast<u64>(width) * height < ParallelPixels ? 1 : std::clamp(std::thread::hardware_concurrency(), 1U, height));
+
+		if(threads == 1)
+		{
+			packRows(0, height);
+			return bitmap;
+		}
+
+		// each thread gets a band of whole rows so they never write the same word
+		std::vector<std::thread> workers;
+		workers.reserve(threads - 1);
+
+		const auto band = (height + threads - 1) / threads;
+
+		for(u32 i = 1; i < threads; ++i)
+		{
+			const auto begin = std::min(height, i * band);
+			workers.emplace_back(packRows, begin, std::min(height, begin + band));
+		}
+
+		packRows(0, std::min(height, band));
+
+		for(auto &worker : workers) worker.join();
+
+		return bitmap;
+	}
+
+	std::vector<RowBitmap::Rectangle> RowBitmap::mergeRectangles() const
+	{
+		std::vector<Rectangle> rectangles;
+
+		// pixels are cleared as they are covered, so what's left set is what still needs a rectangle
+		auto remaining = m_words;
+
+		for(u32 y = 0; y < m_height; ++y)
+		{
+			auto *row = remaining.data() + static_cast<size_t>(y) * m_rowWords;
+
+			for(u32 word = 0; word < m_rowWords; ++word)
+			{
+				// covering a run clears it, so this finds the next uncovered pixel on the row each time
+				while(row[word] != 0)
+				{
+					const auto x = word * 64 + countTrailingZeros(row[word]);
+					const auto width = runFrom(row, m_rowWords, x);
+
+					u32 height = 1;
+
+					while(y + height < m_height && allSet(row + static_cast<size_t>(height) * m_rowWords, x, width)) ++height;
+
+					for(u32 i = 0; i < height; ++i) clear(row + static_cast<size_t>(i) * m_rowWords, x, width);
+
+					rectangles.push_back({ { x, y }, { width, height } });
+				}
+			}
+		}
+
+		return rectangles;
+	}
+
+	u32 RowBitmap::runFrom(const u64 *row, u32 rowWords, u32 x)
+	{
+		auto word = x / 64;
+		const auto shift = x % 64;
+
+		// the bits shifted in at the top are 0, so they read as set and the run carries on into the next word
+		if(const auto unset = ~row[word] >> shift; unset != 0) return countTrailingZeros(unset);
+
+		auto run = 64 - shift;
+
+		for(++word; word < rowWords; ++word)
+		{
+			if(const auto unset = ~row[word]; unset != 0) return run + countTrailingZeros(unset);
+			run += 64;
+		}
+
+		return run;
+	}
+
+	bool RowBitmap::allSet(const u64 *row, u32 x, u32 width)
+	{
+		while(width > 0)
+		{
+			const auto shift = x % 64;
+			const auto count = std::min(width, 64 - shift);
+			const auto mask = bitRange(shift, count);
+
+			if((row[x / 64] & mask) != mask) return false;
+
+			x += count;
+			width -= count;
+		}
+
+		return true;
+	}
+
+	void RowBitmap::clear(u64 *row, u32 x, u32 width)
+	{
+		while(width > 0)
+		{
+			const auto shift = x % 64;
+			const auto count = std::min(width, 64 - shift);
+
+			row[x / 64] &= ~bitRange(shift, count);
+
+			x += count;
+			width -= count;
+		}
+	}
+}
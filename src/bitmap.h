@@ -0,0 +1,48 @@
+#pragma once
+
+#include "types.h"
+#include <vector>
+#include <glm/vec2.hpp>
+
+namespace game::util
+{
+	// a 1 bit per pixel image, each row starts on a new 64 bit word and bit n of a word is pixel n of it
+	class RowBitmap
+	{
+	public:
+		// a rectangle of set pixels, in pixels from the top left
+		struct Rectangle
+		{
+			glm::uvec2 m_position;
+			glm::uvec2 m_size;
+		};
+
+		RowBitmap() = default;
+		RowBitmap(u32 width, u32 height);
+		~RowBitmap() = default;
+
+		// sets the pixels of a 32 bit rgba image whose alpha isn't 0, rows are split between threads
+		[[nodiscard]] static RowBitmap fromAlpha(const u32 *pixels, u32 width, u32 height);
+
+		[[nodiscard]] inline bool at(u32 x, u32 y) const { return (m_words[y * m_rowWords + x / 64] >> (x % 64)) & 1; }
+
+		// covers the set pixels with rectangles, scanning top to bottom then left to right,
+		// each one as wide as the run it starts on and continuing down while the rows below are at least as wide
+		[[nodiscard]] std::vector<Rectangle> mergeRectangles() const;
+
+		[[nodiscard]] inline auto width() const { return m_width; }
+		[[nodiscard]] inline auto height() const { return m_height; }
+
+	private:
+		u32 m_width = 0, m_height = 0;
+		u32 m_rowWords = 0;
+
+		std::vector<u64> m_words;
+
+		// how many set pixels there are in a row starting at x
+		[[nodiscard]] static u32 runFrom(const u64 *row, u32 rowWords, u32 x);
+		// true if every pixel from x to x + width is set
+		[[nodiscard]] static bool allSet(const u64 *row, u32 x, u32 width);
+		static void clear(u64 *row, u32 x, u32 width);
+	};
+}
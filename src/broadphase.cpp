@@ -0,0 +1,124 @@
+#include "broadphase.h"
+#include <algorithm>
+#include <utility>
+
+namespace game::util
+{
+	u32 SweepAndPrune::insert(const Bounds &bounds)
+	{
+		u32 proxy;
+
+		if(!m_freeProxies.empty())
+		{
+			proxy = m_freeProxies.back();
+			m_freeProxies.pop_back();
+		}
+		else
+		{
+			proxy = static_cast<u32>(m_slots.size());
+			m_slots.push_back(NoProxy);
+		}
+
+		const auto slot = static_cast<u32>(m_entries.size());
+
+		m_entries.push_back({ bounds, proxy });
+		m_slots[proxy] = slot;
+		m_maxWidth = std::max(m_maxWidth, bounds.m_max[m_axis] - bounds.m_min[m_axis]);
+
+		resort(slot);
+		changed();
+
+		return proxy;
+	}
+
+	void SweepAndPrune::update(u32 proxy, const Bounds &bounds)
+	{
+		const auto slot = m_slots[proxy];
+
+		m_entries[slot].m_bounds = bounds;
+		m_maxWidth = std::max(m_maxWidth, bounds.m_max[m_axis] - bounds.m_min[m_axis]);
+
+		resort(slot);
+		changed();
+	}
+
+	void SweepAndPrune::remove(u32 proxy)
+	{
+		const auto slot = m_slots[proxy];
+
+		m_entries.erase(std::begin(m_entries) + slot);
+
+		for(auto i = slot; i < m_entries.size(); ++i) m_slots[m_entries[i].m_proxy] = i;
+
+		m_slots[proxy] = NoProxy;
+		m_freeProxies.push_back(proxy);
+
+		check();
+	}
+
+	// one pass of insertion sort, cheap as entries only swap with their neighbours when they overtake them
+	void SweepAndPrune::resort(u32 slot)
+	{
+		const auto axis = m_axis;
+		const auto x = m_entries[slot].m_bounds.m_min[axis];
+
+		while(slot > 0 && m_entries[slot - 1].m_bounds.m_min[axis] > x)
+		{
+			std::swap(m_entries[slot], m_entries[slot - 1]);
+			m_slots[m_entries[slot].m_proxy] = slot;
+			--slot;
+		}
+
+		while(slot + 1 < m_entries.size() && m_entries[slot + 1].m_bounds.m_min[axis] < x)
+		{
+			std::swap(m_entries[slot], m_entries[slot + 1]);
+			m_slots[m_entries[slot].m_proxy] = slot;
+			++slot;
+		}
+
+		m_slots[m_entries[slot].m_proxy] = slot;
+	}
+
+	void SweepAndPrune::changed()
+	{
+		if(++m_changesSinceCheck >= std::max(static_cast<u32>(m_entries.size()), MinCheckInterval)) check();
+	}
+
+	void SweepAndPrune::check()
+	{
+		m_changesSinceCheck = 0;
+
+		if(m_entries.empty())
+		{
+			m_maxWidth = 0.0;
+			return;
+		}
+
+		// the spread of the centres along each axis
+		glm::dvec2 sum { 0.0 }, sumSquares { 0.0 };
+
+		for(const auto &entry : m_entries)
+		{
+			const auto centre = (entry.m_bounds.m_min + entry.m_bounds.m_max) * 0.5;
+
+			sum += centre;
+			sumSquares += centre * centre;
+		}
+
+		const auto count = static_cast<f64>(m_entries.size());
+		const auto variance = sumSquares / count - (sum / count) * (sum / count);
+
+		if(variance[1 - m_axis] > variance[m_axis] * AxisSwitchRatio)
+		{
+			m_axis = 1 - m_axis;
+
+			const auto axis = m_axis;
+			std::sort(std::begin(m_entries), std::end(m_entries), [axis](const Entry &a, const Entry &b) { return a.m_bounds.m_min[axis] < b.m_bounds.m_min[axis]; });
+
+			for(u32 i = 0; i < m_entries.size(); ++i) m_slots[m_entries[i].m_proxy] = i;
+		}
+
+		m_maxWidth = 0.0;
+		for(const auto &entry : m_entries) m_maxWidth = std::max(m_maxWidth, entry.m_bounds.m_max[m_axis] - entry.m_bounds.m_min[m_axis]);
+	}
+}
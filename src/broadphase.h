@@ -0,0 +1,87 @@
+#pragma once
+
+#include "types.h"
+#include "util.h"
+#include <vector>
+#include <algorithm>
+
+namespace game::util
+{
+	// sort and sweep over moving bounds, the entries are kept sorted by their low edge along one axis
+	// things only move a little each tick so keeping them sorted is mostly a no-op,
+	// the axis is whichever the entries are most spread out along, checked again every so often as they move
+	class SweepAndPrune
+	{
+	public:
+		static constexpr u32 NoProxy = ~0u;
+
+		SweepAndPrune() = default;
+		~SweepAndPrune() = default;
+
+		// returns the proxy used to refer to these bounds from now on
+		u32 insert(const Bounds &bounds);
+		void update(u32 proxy, const Bounds &bounds);
+		void remove(u32 proxy);
+
+		// calls visit with every proxy whose bounds overlap bounds
+		template <typename Visit>
+		void forEach(const Bounds &bounds, Visit &&visit) const
+		{
+			static_cast<void>(any(bounds, [&visit](u32 proxy) { visit(proxy); return false; }));
+		}
+
+		// calls test with every proxy whose bounds overlap bounds, stops and returns true as soon as test does
+		template <typename Test>
+		bool any(const Bounds &bounds, Test &&test) const
+		{
+			const auto axis = m_axis, across = 1 - m_axis;
+
+			const auto min = bounds.m_min[axis] - QueryPadding;
+			const auto max = bounds.m_max[axis] + QueryPadding;
+
+			// nothing wider than m_maxWidth can start further back than this and still reach the query
+			auto it = std::lower_bound(std::cbegin(m_entries), std::cend(m_entries), min - m_maxWidth,
+									   [axis](const Entry &entry, f64 x) { return entry.m_bounds.m_min[axis] < x; });
+
+			for(; it != std::cend(m_entries) && it->m_bounds.m_min[axis] <= max; ++it)
+			{
+				const auto &other = it->m_bounds;
+
+				if(other.m_max[axis] >= min && other.m_min[across] <= bounds.m_max[across] + QueryPadding && other.m_max[across] >= bounds.m_min[across] - QueryPadding && test(it->m_proxy)) return true;
+			}
+
+			return false;
+		}
+
+		[[nodiscard]] inline auto size() const { return m_entries.size(); }
+
+		// 0 for x, 1 for y
+		[[nodiscard]] inline auto axis() const { return m_axis; }
+
+	private:
+		struct Entry
+		{
+			Bounds m_bounds;
+			u32 m_proxy;
+		};
+
+		std::vector<Entry> m_entries;
+		std::vector<u32> m_slots; // where each proxy is in m_entries, NoProxy if it is free
+		std::vector<u32> m_freeProxies;
+
+		static constexpr u32 MinCheckInterval = 64;
+		static constexpr f64 AxisSwitchRatio = 1.5; // how much more spread out the other axis has to be, so similar spreads don't swap back and forth
+
+		u32 m_axis = 0;
+		f64 m_maxWidth = 0.0; // the widest along m_axis any entry has been since the last check
+		u32 m_changesSinceCheck = 0;
+
+		// moves the entry at slot back or forward until the entries are sorted again
+		void resort(u32 slot);
+
+		// every size() changes, at least MinCheckInterval, picks the axis again and works out m_maxWidth from scratch
+		// so one wide entry doesn't widen every query from then on
+		void changed();
+		void check();
+	};
+}
@@ -0,0 +1,144 @@
+#include "bvh.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+
+namespace game::util
+{
+	namespace
+	{
+		constexpr f64 TraversalCost = 1.0; // relative to testing one box
+
+		// the 2d version of surface area, half the perimeter
+		inline f64 halfPerimeter(const Bounds &bounds)
+		{
+			const auto size = bounds.m_max - bounds.m_min;
+			return size.x + size.y;
+		}
+
+		inline void grow(Bounds &bounds, const Bounds &other)
+		{
+			bounds.m_min = glm::min(bounds.m_min, other.m_min);
+			bounds.m_max = glm::max(bounds.m_max, other.m_max);
+		}
+
+		constexpr Bounds EmptyBounds { glm::dvec2 { INFINITY }, glm::dvec2 { -INFINITY } };
+	}
+
+	HitboxBvh::HitboxBvh(const std::vector<OrientedBoundingBox> &boxes)
+	{
+		if(boxes.empty()) return;
+
+		std::vector<Bounds> bounds;
+		bounds.reserve(boxes.size());
+		for(const auto &box : boxes) bounds.push_back(box.bounds());
+
+		m_boxes.resize(boxes.size());
+		for(u32 i = 0; i < m_boxes.size(); ++i) m_boxes[i] = i;
+
+		m_nodes.reserve(2 * boxes.size() / MaxLeafSize + 1);
+
+		build(bounds, 0, static_cast<u32>(boxes.size()), 0);
+
+		m_boxBounds.reserve(boxes.size());
+		m_leafBoxes.reserve(boxes.size());
+
+		for(const auto box : m_boxes)
+		{
+			m_boxBounds.push_back(bounds[box]);
+			m_leafBoxes.push_back(boxes[box]);
+		}
+	}
+
+	void HitboxBvh::build(const std::vector<Bounds> &bounds, u32 begin, u32 end, u32 depth)
+	{
+		const auto node = static_cast<u32>(m_nodes.size());
+		const auto count = end - begin;
+
+		auto nodeBounds = EmptyBounds;
+		auto centroidBounds = EmptyBounds;
+
+		for(u32 i = begin; i < end; ++i)
+		{
+			const auto &box = bounds[m_boxes[i]];
+			const auto centre = (box.m_min + box.m_max) / 2.0;
+
+			grow(nodeBounds, box);
+			grow(centroidBounds, { centre, centre });
+		}
+
+		m_nodes.push_back({ nodeBounds, begin, count });
+
+		const auto extent = centroidBounds.m_max - centroidBounds.m_min;
+		const auto axis = extent.x >= extent.y ? 0 : 1;
+
+		// boxes all centred on the same point can't be split, and the traversal stack has a fixed size
+		if(count <= 1 || extent[axis] <= 0.0 || depth + 1 >= MaxDepth) return;
+
+		const auto binOf = [&bounds, &centroidBounds, &extent, axis](u32 box)
+		{
+			const auto centre = (bounds[box].m_min[axis] + bounds[box].m_max[axis]) / 2.0;
+			return std::min(Bins - 1, static_cast<u32>((centre - centroidBounds.m_min[axis]) / extent[axis] * Bins));
+		};
+
+		std::array<Bounds, Bins> binBounds;
+		std::array<u32, Bins> binCounts {};
+		binBounds.fill(EmptyBounds);
+
+		for(u32 i = begin; i < end; ++i)
+		{
+			const auto bin = binOf(m_boxes[i]);
+
+			grow(binBounds[bin], bounds[m_boxes[i]]);
+			++binCounts[bin];
+		}
+
+		// cost of splitting after each bin, from the boxes on either side
+		std::array<f64, Bins - 1> splitCosts;
+
+		auto left = EmptyBounds;
+		u32 leftCount = 0;
+
+		for(u32 bin = 0; bin < Bins - 1; ++bin)
+		{
+			grow(left, binBounds[bin]);
+			leftCount += binCounts[bin];
+			splitCosts[bin] = leftCount == 0 ? INFINITY : halfPerimeter(left) * leftCount;
+		}
+
+		auto right = EmptyBounds;
+		u32 rightCount = 0;
+
+		for(u32 bin = Bins - 1; bin > 0; --bin)
+		{
+			grow(right, binBounds[bin]);
+			rightCount += binCounts[bin];
+			splitCosts[bin - 1] = rightCount == 0 ? INFINITY : splitCosts[bin - 1] + halfPerimeter(right) * rightCount;
+		}
+
+		const auto best = static_cast<u32>(std::min_element(std::cbegin(splitCosts), std::cend(splitCosts)) - std::cbegin(splitCosts));
+
+		const auto area = halfPerimeter(nodeBounds);
+		const auto splitCost = TraversalCost * area + splitCosts[best];
+		const auto leafCost = static_cast<f64>(count) * area;
+
+		if(count <= MaxLeafSize && leafCost <= splitCost) return;
+
+		const auto middle = static_cast<u32>(std::partition(std::begin(m_boxes) + begin, std::begin(m_boxes) + end, [&binOf, best](u32 box) { return binOf(box) <= best; }) - std::begin(m_boxes));
+
+		if(middle == begin || middle == end) return;
+
+		m_nodes[node].m_count = 0;
+
+		build(bounds, begin, middle, depth + 1);
+
+		m_nodes[node].m_first = static_cast<u32>(m_nodes.size());
+
+		build(bounds, middle, end, depth + 1);
+	}
+
+	bool HitboxBvh::intersects(const OrientedBoundingBox &box) const
+	{
+		return anyLeaf(box.bounds(), [this, &box](u32 slot) { return box.intersects(m_leafBoxes[slot]); });
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "types.h"
+#include "util.h"
+#include <vector>
+#include <array>
+
+namespace game::util
+{
+	// bounding volume hierarchy over static hitboxes, split with the surface area heuristic
+	// unlike HitboxGrid it doesn't care how big, how rotated or how spread out the boxes are
+	class HitboxBvh
+	{
+	public:
+		HitboxBvh() = default;
+		explicit HitboxBvh(const std::vector<OrientedBoundingBox> &boxes);
+		~HitboxBvh() = default;
+
+		// calls visit with the index of every box whose bounds overlap bounds
+		template <typename Visit>
+		void forEach(const Bounds &bounds, Visit &&visit) const
+		{
+			static_cast<void>(any(bounds, [&visit](u32 box) { visit(box); return false; }));
+		}
+
+		// calls test with the index of every box whose bounds overlap bounds, stops and returns true as soon as test does
+		template <typename Test>
+		bool any(const Bounds &bounds, Test &&test) const
+		{
+			return anyLeaf(bounds, [this, &test](u32 slot) { return test(m_boxes[slot]); });
+		}
+
+		// true if box intersects any of the boxes
+		[[nodiscard]] bool intersects(const OrientedBoundingBox &box) const;
+
+		[[nodiscard]] inline auto nodes() const { return static_cast<u32>(m_nodes.size()); }
+
+	private:
+		static constexpr u32 MaxLeafSize = 8;
+		static constexpr u32 Bins = 16;
+		static constexpr u32 MaxDepth = 64;
+
+		// nodes are stored depth first so a node's left child comes straight after it
+		struct Node
+		{
+			Bounds m_bounds;
+			u32 m_first; // the first box of a leaf, or the right child of an interior node
+			u32 m_count; // 0 for interior nodes
+		};
+
+		std::vector<Node> m_nodes;
+		std::vector<u32> m_boxes; // box indices in leaf order
+		std::vector<Bounds> m_boxBounds; // in the same order as m_boxes
+		std::vector<OrientedBoundingBox> m_leafBoxes; // copies in the same order as m_boxes, with their geometry already cached
+
+		// like any but test gets the box's slot in leaf order, for looking it up in m_boxes or m_leafBoxes
+		template <typename Test>
+		bool anyLeaf(const Bounds &bounds, Test &&test) const
+		{
+			if(m_nodes.empty()) return false;
+
+			std::array<u32, MaxDepth> stack;
+			u32 top = 0;
+			u32 node = 0;
+
+			while(true)
+			{
+				const auto &current = m_nodes[node];
+
+				if(overlaps(current.m_bounds, bounds))
+				{
+					if(current.m_count == 0)
+					{
+						// the left child is always the next node, the right one goes on the stack for later
+						stack[top++] = current.m_first;
+						++node;
+						continue;
+					}
+
+					for(u32 i = current.m_first; i < current.m_first + current.m_count; ++i)
+					{
+						if(overlaps(m_boxBounds[i], bounds) && test(i)) return true;
+					}
+				}
+
+				if(top == 0) return false;
+				node = stack[--top];
+			}
+		}
+
+		[[nodiscard]] static inline bool overlaps(const Bounds &a, const Bounds &b)
+		{
+			return a.m_min.x <= b.m_max.x + QueryPadding && a.m_max.x >= b.m_min.x - QueryPadding &&
+				   a.m_min.y <= b.m_max.y + QueryPadding && a.m_max.y >= b.m_min.y - QueryPadding;
+		}
+
+		void build(const std::vector<Bounds> &bounds, u32 begin, u32 end, u32 depth);
+	};
+}
@@ -0,0 +1,216 @@
+#include "carbatch.h"
+#include "physics.h"
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// every field is its own array, so tell the compiler the loops over them don't need checking for overlap
+#if defined(__clang__)
+#define GAME_CARBATCH_INDEPENDENT _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define GAME_CARBATCH_INDEPENDENT _Pragma("GCC ivdep")
+#elif defined(_MSC_VER)
+#define GAME_CARBATCH_INDEPENDENT __pragma(loop(ivdep))
+#else
+#define GAME_CARBATCH_INDEPENDENT
+#endif
+
+namespace game
+{
+	namespace
+	{
+		template <typename To, typename From>
+		inline physics::CarMotion<To> motionCast(const physics::CarMotion<From> &motion)
+		{
+			return { glm::vec<2, To>(motion.m_velocity), glm::vec<2, To>(motion.m_localAccel), static_cast<To>(motion.m_absoluteVelocity), static_cast<To>(motion.m_yawRate) };
+		}
+	}
+
+	template <typename T>
+	BasicCarBatch<T>::BasicCarBatch(u32 spec)
+		: m_spec(spec)
+	{
+		// tick indexes its table of models with this
+		if(spec >= physics::CarSpecs.size()) throw std::out_of_range("no car spec " + std::to_string(spec));
+	}
+
+	template <typename T>
+	u32 BasicCarBatch<T>::add(glm::dvec2 position, f64 rotation)
+	{
+		const auto car = size();
+
+		m_x.push_back(static_cast<T>(position.x));
+		m_y.push_back(static_cast<T>(position.y));
+		m_rotation.push_back(static_cast<T>(rotation));
+
+		m_velocityX.push_back(T(0));
+		m_velocityY.push_back(T(0));
+		m_localAccelX.push_back(T(0));
+		m_localAccelY.push_back(T(0));
+		m_absoluteVelocity.push_back(T(0));
+		m_yawRate.push_back(T(0));
+
+		m_inputs.push_back(0);
+
+		for(auto *scratch : scratchFields()) scratch->resize(size());
+
+		return car;
+	}
+
+	template <typename T>
+	void BasicCarBatch<T>::reserve(size_t count)
+	{
+		for(auto *field : { &m_x, &m_y, &m_rotation, &m_velocityX, &m_velocityY, &m_localAccelX, &m_localAccelY, &m_absoluteVelocity, &m_yawRate }) field->reserve(count);
+		for(auto *scratch : scratchFields()) scratch->reserve(count);
+
+		m_inputs.reserve(count);
+	}
+
+	template <typename T>
+	std::array<std::vector<T> *, 16> BasicCarBatch<T>::scratchFields()
+	{
+		return { &m_sin, &m_cos, &m_steer, &m_throttle, &m_brakeForce, &m_rearGrip, &m_cosSteer,
+				 &m_localVelocityX, &m_localVelocityY, &m_frontLateral, &m_rearLateral, &m_forward,
+				 &m_slipAngleFront, &m_slipAngleRear, &m_startX, &m_startY };
+	}
+
+	// tickAs for every spec in physics::CarSpecs, in the same order
+	template <typename T>
+	template <size_t... Specs>
+	constexpr auto BasicCarBatch<T>::tickTable(std::index_sequence<Specs...>)
+	{
+		return std::array { &BasicCarBatch::tickAs<*physics::CarSpecs[Specs]>... };
+	}
+
+	template <typename T>
+	void BasicCarBatch<T>::tick(const Track &track, f64 delta)
+	{
+		static constexpr auto Ticks = tickTable(std::make_index_sequence<physics::CarSpecs.size()>());
+
+		(this->*Ticks[m_spec])(track, delta);
+	}
+
+	// the model runs in passes over every car, the ones without trig calls have no branches the compiler can't turn into selects
+	// so they vectorise, the trig is left to its own passes
+	template <typename T>
+	template <const physics::CarSpec &Spec>
+	void BasicCarBatch<T>::tickAs(const Track &track, f64 delta)
+	{
+		using std::sin, std::cos;
+
+		const auto cars = size();
+		const auto step = static_cast<T>(delta);
+
+		for(u32 i = 0; i < cars; ++i)
+		{
+			const auto bits = m_inputs[i];
+			const auto input = [bits](size_t index) { return ((bits >> index) & 1) != 0; };
+
+			const auto carControls = physics::carControls<Spec>(input(Car::Accelerate), input(Car::Reverse), input(Car::Brake), input(Car::Left), input(Car::Right), input(Car::Handbrake), m_absoluteVelocity[i]);
+
+			m_steer[i] = carControls.m_steer;
+			m_throttle[i] = carControls.m_throttle;
+			m_brakeForce[i] = carControls.m_brakeForce;
+			m_rearGrip[i] = carControls.m_rearGrip;
+
+			m_sin[i] = sin(m_rotation[i]);
+			m_cos[i] = cos(m_rotation[i]);
+			m_cosSteer[i] = cos(carControls.m_steer);
+		}
+
+		GAME_CARBATCH_INDEPENDENT
+		for(u32 i = 0; i < cars; ++i)
+		{
+			const auto carSlip = physics::carSlip<Spec>(motion(i), m_sin[i], m_cos[i]);
+
+			m_localVelocityX[i] = carSlip.m_localVelocity.x;
+			m_localVelocityY[i] = carSlip.m_localVelocity.y;
+			m_frontLateral[i] = carSlip.m_frontLateral;
+			m_rearLateral[i] = carSlip.m_rearLateral;
+			m_forward[i] = carSlip.m_forward;
+		}
+
+		for(u32 i = 0; i < cars; ++i)
+		{
+			const auto angles = physics::carSlipAngles(slip(i), controls(i));
+
+			m_slipAngleFront[i] = angles.x;
+			m_slipAngleRear[i] = angles.y;
+		}
+
+		GAME_CARBATCH_INDEPENDENT
+		for(u32 i = 0; i < cars; ++i)
+		{
+			auto carMotion = motion(i);
+			physics::carIntegrate<Spec>(carMotion, slip(i), { m_slipAngleFront[i], m_slipAngleRear[i] }, controls(i), m_sin[i], m_cos[i], m_cosSteer[i], step);
+			setMotion(i, carMotion);
+
+			m_startX[i] = m_x[i];
+			m_startY[i] = m_y[i];
+
+			m_x[i] += carMotion.m_velocity.x * step;
+			m_y[i] += carMotion.m_velocity.y * step;
+			m_rotation[i] += carMotion.m_yawRate * step;
+		}
+
+		for(u32 i = 0; i < cars; ++i) collide<Spec>(i, track, step);
+	}
+
+	// the track only tests f64 and fixed point boxes, so a floating point batch's wall response runs in f64 whatever its precision
+	template <typename T>
+	template <const physics::CarSpec &Spec>
+	void BasicCarBatch<T>::collide(u32 car, const Track &track, T delta)
+	{
+		using C = std::conditional_t<std::is_floating_point_v<T>, f64, T>;
+
+		util::BasicOrientedBoundingBox<C> hitbox({ static_cast<C>(m_x[car]), static_cast<C>(m_y[car]) }, static_cast<C>(m_rotation[car]), physics::CarConstants<Spec, C>::Size);
+
+		const auto contact = [&track, &hitbox]() -> std::optional<util::BasicContact<C>>
+		{
+			if(!track.intersects(hitbox)) return std::nullopt;
+			if constexpr(std::is_same_v<C, f64>)
+			{
+				if(const auto hit = track.contact(hitbox)) return hit->m_contact;
+				return std::nullopt;
+			}
+			else return track.contact(hitbox);
+		};
+
+		auto carMotion = motionCast<C>(motion(car));
+
+		const glm::vec<2, C> start { static_cast<C>(m_startX[car]), static_cast<C>(m_startY[car]) };
+		const auto displacement = carMotion.m_velocity * static_cast<C>(delta);
+
+		// the first wall along the move comes before whatever the end of the move is inside, like Car::integrate
+		auto impact = util::infinity<C>();
+
+		if(physics::canTunnel(hitbox.m_size, displacement))
+		{
+			auto from = hitbox;
+			from.m_position = start;
+
+			impact = track.timeOfImpact(from, displacement);
+			if(impact <= C(1)) hitbox.m_position = start + displacement * impact;
+		}
+
+		auto hit = contact();
+
+		if(impact <= C(1) && !hit) physics::carBounceBack(carMotion);
+
+		for(u32 i = 0; hit && i < physics::MaxContactIterations; ++i, hit = contact())
+		{
+			physics::carBounce(carMotion, hitbox.m_position, *hit);
+		}
+
+		m_x[car] = static_cast<T>(hitbox.m_position.x);
+		m_y[car] = static_cast<T>(hitbox.m_position.y);
+
+		setMotion(car, motionCast<T>(carMotion));
+	}
+
+	template class BasicCarBatch<f32>;
+	template class BasicCarBatch<f64>;
+	template class BasicCarBatch<util::Fixed>;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "types.h"
+#include "util.h"
+#include "game.h"
+#include "fixed.h"
+#include <vector>
+#include <array>
+#include <utility>
+
+namespace game
+{
+	// many cars without an entity each, every field in its own array so the physics runs as loops over all of them
+	// gives the same results as a Car in a World with only the track, cars in a batch don't collide with each other
+	// T is the scalar the physics runs in, an f32 batch fits twice as many cars in a vector and drifts from the f64 one over time,
+	// a util::Fixed batch gives the same results for the same inputs on every machine, which World and so replays don't
+	// every car in a batch has the same physics::CarSpec, picked by its index in physics::CarSpecs
+	template <typename T>
+	class BasicCarBatch
+	{
+	public:
+		BasicCarBatch() = default;
+		// spec is an index into physics::CarSpecs, physics::findCarSpec gives it from a name,
+		// throws std::out_of_range if there's no spec there
+		explicit BasicCarBatch(u32 spec);
+		~BasicCarBatch() = default;
+
+		// returns the index used for the car from now on
+		u32 add(glm::dvec2 position, f64 rotation = util::toRad(90.0));
+		void reserve(size_t count);
+
+		// the inputs to use from the next tick, the same bits as Car::inputBits
+		inline void setInputs(u32 car, u8 bits) { m_inputs[car] = bits; }
+
+		// runs the model built for the batch's spec, one indirect call per tick for the whole batch
+		void tick(const Track &track, f64 delta);
+
+		[[nodiscard]] inline CarPose pose(u32 car) const { return { { static_cast<f64>(m_x[car]), static_cast<f64>(m_y[car]) }, static_cast<f64>(m_rotation[car]) }; }
+		[[nodiscard]] inline auto size() const { return static_cast<u32>(m_x.size()); }
+		[[nodiscard]] inline auto spec() const { return m_spec; }
+
+	private:
+		u32 m_spec = 0;
+
+		std::vector<T> m_x, m_y;
+		std::vector<T> m_rotation;
+
+		// physics::CarMotion split up
+		std::vector<T> m_velocityX, m_velocityY;
+		std::vector<T> m_localAccelX, m_localAccelY;
+		std::vector<T> m_absoluteVelocity;
+		std::vector<T> m_yawRate;
+
+		std::vector<u8> m_inputs;
+
+		// worked out again every tick, kept to save allocating them
+		std::vector<T> m_sin, m_cos;
+		std::vector<T> m_steer, m_throttle, m_brakeForce, m_rearGrip, m_cosSteer; // physics::CarControls split up
+		std::vector<T> m_localVelocityX, m_localVelocityY, m_frontLateral, m_rearLateral, m_forward; // physics::CarSlip split up
+		std::vector<T> m_slipAngleFront, m_slipAngleRear;
+		std::vector<T> m_startX, m_startY;
+
+		[[nodiscard]] inline physics::CarMotion<T> motion(u32 car) const
+		{
+			return { { m_velocityX[car], m_velocityY[car] }, { m_localAccelX[car], m_localAccelY[car] }, m_absoluteVelocity[car], m_yawRate[car] };
+		}
+
+		[[nodiscard]] inline physics::CarControls<T> controls(u32 car) const { return { m_steer[car], m_throttle[car], m_brakeForce[car], m_rearGrip[car] }; }
+
+		[[nodiscard]] inline physics::CarSlip<T> slip(u32 car) const
+		{
+			return { { m_localVelocityX[car], m_localVelocityY[car] }, m_frontLateral[car], m_rearLateral[car], m_forward[car] };
+		}
+
+		inline void setMotion(u32 car, const physics::CarMotion<T> &motion)
+		{
+			m_velocityX[car] = motion.m_velocity.x;
+			m_velocityY[car] = motion.m_velocity.y;
+			m_localAccelX[car] = motion.m_localAccel.x;
+			m_localAccelY[car] = motion.m_localAccel.y;
+			m_absoluteVelocity[car] = motion.m_absoluteVelocity;
+			m_yawRate[car] = motion.m_yawRate;
+		}
+
+		std::array<std::vector<T> *, 16> scratchFields();
+
+		template <const physics::CarSpec &Spec>
+		void tickAs(const Track &track, f64 delta);
+
+		template <size_t... Specs>
+		static constexpr auto tickTable(std::index_sequence<Specs...>);
+
+		// the same wall response as Car::integrate for one car
+		template <const physics::CarSpec &Spec>
+		void collide(u32 car, const Track &track, T delta);
+	};
+
+	using CarBatch = BasicCarBatch<f64>;
+	using CarBatch32 = BasicCarBatch<f32>;
+	using FixedCarBatch = BasicCarBatch<util::Fixed>;
+
+	extern template class BasicCarBatch<f32>;
+	extern template class BasicCarBatch<f64>;
+	extern template class BasicCarBatch<util::Fixed>;
+}
@@ -0,0 +1,251 @@
+#include "game.h"
+#include "tick.h"
+#include "replay.h"
+#include "carbatch.h"
+#include "clock.h"
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <glm/geometric.hpp>
+
+namespace
+{
+	using namespace game;
+
+	// the flag that picks collision
+	const char *collisionFlag(TrackCollision collision)
+	{
+		switch(collision)
+		{
+		case TrackCollision::Hitboxes: break;
+		case TrackCollision::Bvh: return "--bvh";
+		case TrackCollision::DistanceField: return "--sdf";
+		}
+
+		return "no --sdf or --bvh";
+	}
+
+	// drives an f64 CarBatch and an Other batch with the cars' inputs side by side and prints how far apart they get,
+	// batches don't collide cars with each other so this is the physics and wall response on their own
+	template <typename Other>
+	void measureDrift(const std::vector<std::shared_ptr<Car>> &cars, const Track &track, u64 maxTicks, f64 tickRate, const std::string &name)
+	{
+		CarBatch batch;
+		Other other;
+
+		for(const auto &car : cars)
+		{
+			const auto pose = car->pose(1.0);
+
+			batch.add(pose.m_position, pose.m_rotation);
+			other.add(pose.m_position, pose.m_rotation);
+		}
+
+		const auto delta = 1.0 / tickRate;
+		const auto reportTicks = std::max(static_cast<u64>(tickRate * 10.0), u64 { 1 }); // every ten seconds of racing
+
+		f64 worstPosition = 0.0, worstRotation = 0.0;
+
+		for(u64 tick = 0; tick < maxTicks; ++tick)
+		{
+			for(u32 i = 0; i < cars.size(); ++i)
+			{
+				cars[i]->updateInputs(static_cast<u64>(static_cast<f64>(tick) * TicksPerSecond / tickRate));
+
+				batch.setInputs(i, cars[i]->inputBits());
+				other.setInputs(i, cars[i]->inputBits());
+			}
+
+			batch.tick(track, delta);
+			other.tick(track, delta);
+
+			f64 position = 0.0, rotation = 0.0, total = 0.0;
+
+			for(u32 i = 0; i < batch.size(); ++i)
+			{
+				const auto pose = batch.pose(i);
+				const auto otherPose = other.pose(i);
+
+				const auto distance = glm::distance(pose.m_position, otherPose.m_position);
+
+				position = std::max(position, distance);
+				rotation = std::max(rotation, std::abs(pose.m_rotation - otherPose.m_rotation));
+				total += distance;
+			}
+
+			worstPosition = std::max(worstPosition, position);
+			worstRotation = std::max(worstRotation, rotation);
+
+			if((tick + 1) % reportTicks == 0 || tick + 1 == maxTicks)
+			{
+				std::cout << "tick " << (tick + 1) << " (" << (static_cast<f64>(tick + 1) * delta) << " s): " << name << " is up to " << position << " m and "
+						  << rotation << " rad from f64, " << (total / std::max(batch.size(), 1U)) << " m on average" << std::endl;
+			}
+		}
+
+		std::cout << "worst drift " << worstPosition << " m, " << worstRotation << " rad" << std::endl;
+
+		// fixed point gives the same poses on every machine, so this should be too
+		if constexpr(std::is_same_v<Other, FixedCarBatch>)
+		{
+			u64 hash = 14695981039346656037ULL;
+
+			const auto mix = [&hash](f64 value)
+			{
+				u64 bits;
+				std::memcpy(&bits, &value, sizeof(bits));
+				hash = (hash ^ bits) * 1099511628211ULL;
+			};
+
+			for(u32 i = 0; i < other.size(); ++i)
+			{
+				const auto pose = other.pose(i);
+
+				mix(pose.m_position.x);
+				mix(pose.m_position.y);
+				mix(pose.m_rotation);
+			}
+
+			std::cout << "fixed point poses hash to " << std::hex << hash << std::dec << std::endl;
+		}
+	}
+}
+
+// runs a race with no window as fast as the cpu allows
+// usage: racing_sim_cli [--record <file>] [--replay <file>] [--sdf | --bvh] [--hz <ticks per second>] [--drift [--fixed]] [max ticks]
+// --drift runs the same inputs through f64 and f32 physics instead of racing and prints how far apart they end up,
+// with --fixed it's fixed point instead of f32 and the fixed point poses are hashed to compare between machines
+// --replay runs at the tick rate, substeps and collision the recording was made with
+int main(int argc, char **argv)
+{
+	using namespace game;
+
+	u64 maxTicks = 0;
+	bool maxTicksSet = false;
+
+	// running at a lower rate than the game is useful to check fast cars don't go through walls
+	f64 tickRate = TicksPerSecond;
+	// physics steps per tick, more is more accurate without changing the rate the cars' inputs run at
+	u32 substeps = 1;
+
+	std::string recordPath, replayPath;
+	auto collision = TrackCollision::Hitboxes;
+	bool drift = false, fixed = false, realtime = false;
+	bool tickRateSet = false, substepsSet = false, collisionSet = false;
+
+	for(i32 i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+
+		if(arg == "--record" && i + 1 < argc) recordPath = argv[++i];
+		else if(arg == "--replay" && i + 1 < argc) replayPath = argv[++i];
+		else if(arg == "--sdf") { collision = TrackCollision::DistanceField; collisionSet = true; }
+		else if(arg == "--bvh") { collision = TrackCollision::Bvh; collisionSet = true; }
+		else if(arg == "--hz" && i + 1 < argc) { tickRate = std::stod(argv[++i]); tickRateSet = true; }
+		else if(arg == "--substeps" && i + 1 < argc) { substeps = static_cast<u32>(std::stoul(argv[++i])); substepsSet = true; }
+		else if(arg == "--drift") drift = true;
+		else if(arg == "--fixed") fixed = true;
+		else if(arg == "--realtime") realtime = true;
+		else
+		{
+			maxTicks = std::stoull(arg);
+			maxTicksSet = true;
+		}
+	}
+
+	// ten minutes of racing unless told otherwise
+	if(!maxTicksSet) maxTicks = static_cast<u64>(tickRate * 600.0);
+
+	std::shared_ptr<const InputRecording> recording;
+
+	if(!replayPath.empty())
+	{
+		auto loaded = loadRecording(replayPath);
+		if(!loaded) return 1;
+
+		recording = std::make_shared<const InputRecording>(std::move(*loaded));
+		if(!maxTicksSet) maxTicks = recording->ticks();
+
+		// any other settings would replay the inputs into a different race
+		if((tickRateSet && tickRate != recording->m_tickRate) || (substepsSet && substeps != recording->m_substeps) || (collisionSet && collision != recording->m_collision))
+		{
+			std::cerr << '\"' << replayPath << "\" was recorded with --hz " << recording->m_tickRate << ", --substeps " << recording->m_substeps
+					  << " and " << collisionFlag(recording->m_collision) << ", replay it with the same or without them" << std::endl;
+			return 1;
+		}
+
+		tickRate = recording->m_tickRate;
+		substeps = recording->m_substeps;
+		collision = recording->m_collision;
+	}
+
+	const auto track = std::make_shared<Track>(collision);
+
+	std::vector<std::shared_ptr<Car>> cars;
+
+	if(recording)
+	{
+		for(u32 i = 0; i < recording->m_cars.size(); ++i) cars.push_back(std::make_shared<ReplayCar>(recording, i));
+	}
+	else
+	{
+		for(u32 i = 0; i < NpcCarCount; ++i) cars.push_back(std::make_shared<NpcCar>(i));
+	}
+
+	if(drift)
+	{
+		if(fixed) measureDrift<FixedCarBatch>(cars, *track, maxTicks, tickRate, "fixed point");
+		else measureDrift<CarBatch32>(cars, *track, maxTicks, tickRate, "f32");
+		return 0;
+	}
+
+	World world(recording ? recording->m_racers : NpcCarCount, 1, substeps);
+
+	world.addEntity(track);
+	for(const auto &car : cars) world.addEntity(car);
+
+	if(!recordPath.empty() && !world.startRecording(recordPath, tickRate)) return 1;
+
+	// the race runs as fast as it can be simulated unless --realtime waits for every tick like the game does,
+	// the lap times are in simulated time either way
+	const auto clock = realtime ? std::make_unique<util::RealClock>() : nullptr;
+
+	const auto startTime = util::now();
+	const auto clockStart = clock ? clock->now() : 0.0;
+
+	u64 tick = 0;
+
+	const auto delta = 1.0 / tickRate;
+
+	while(tick < maxTicks && !world.finished())
+	{
+		// cars time their inputs in game ticks, so pass the game tick this tick starts on, like TickThread does
+		world.tick(delta, static_cast<u64>(static_cast<f64>(tick++) * TicksPerSecond / tickRate));
+
+		if(clock) clock->sleepUntil(clockStart + static_cast<f64>(tick) * delta);
+	}
+
+	const auto elapsed = util::now() - startTime;
+
+	world.stopRecording();
+
+	std::cout << "simulated " << tick << " ticks (" << world.time() << " s) in " << elapsed << " s, "
+			  << (static_cast<f64>(tick) / elapsed) << " ticks/s, " << (world.time() / elapsed) << "x real time" << std::endl;
+
+	for(size_t i = 0; i < cars.size(); ++i)
+	{
+		const auto pose = cars[i]->pose(1.0);
+
+		std::cout << "car " << i << ": " << cars[i]->laps() << " laps, last lap " << cars[i]->lastLapTime() << " s, at "
+				  << std::setprecision(17) << pose.m_position.x << ", " << pose.m_position.y << " facing " << pose.m_rotation
+				  << std::setprecision(6) << std::endl;
+	}
+
+	return 0;
+}
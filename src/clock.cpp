@@ -0,0 +1,56 @@
+#include "clock.h"
+#include "util.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <ctime>
+#endif
+
+namespace game::util
+{
+	f64 RealClock::now() const
+	{
+		return util::now();
+	}
+
+	std::optional<f64> RealClock::sleepUntil(f64 time)
+	{
+		const auto wake = time - slack();
+
+		std::optional<f64> late;
+
+		if(now() < wake)
+		{
+			sleepUntilOs(wake);
+
+			late = now() - wake;
+
+			m_lateness += (*late - m_lateness) / 8.0;
+			m_deviation += (std::abs(*late - m_lateness) - m_deviation) / 4.0;
+			m_slack.store(std::clamp(m_lateness + 4.0 * m_deviation, 0.0, MaxSlack), std::memory_order_relaxed);
+		}
+
+		// spin for the rest, which is at most the slack unless the sleep woke up even later
+		while(now() < time) {}
+
+		return late;
+	}
+
+	void RealClock::sleepUntilOs(f64 time) const
+	{
+#if defined(__linux__)
+		// steady_clock is CLOCK_MONOTONIC here, so the deadline is now()'s own time on it and can't drift by however long
+		// getting to the sleep took, rounded up so it's never before time
+		const auto deadlineNs = steadyNanoseconds(time);
+		const timespec deadline { static_cast<time_t>(deadlineNs / 1'000'000'000), static_cast<long>(deadlineNs % 1'000'000'000) };
+
+		while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {}
+#else
+		std::this_thread::sleep_for(std::chrono::duration<f64>(time - now()));
+#endif
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "types.h"
+#include <atomic>
+#include <optional>
+
+namespace game::util
+{
+	// where TickThread gets the time from and how it waits for the next tick
+	class Clock
+	{
+	public:
+		Clock() = default;
+		virtual ~Clock() = default;
+
+		// seconds, never goes backwards
+		[[nodiscard]] virtual f64 now() const = 0;
+
+		// returns once now() has reached time, and how late the OS woke the thread after the time the clock asked it for
+		// if it slept at all, seconds
+		virtual std::optional<f64> sleepUntil(f64 time) = 0;
+
+		Clock(const Clock &) = delete;
+		Clock(Clock &&) = delete;
+
+		Clock &operator=(const Clock &) = delete;
+		Clock &operator=(Clock &&) = delete;
+	};
+
+	// util::now(), sleeping for real, only one thread should sleep on it at a time
+	// sleeps to an absolute deadline a little early and spins the rest, how early is learnt from how late
+	// the sleeps have woken up, so the spin is as short as this machine's scheduler allows
+	class RealClock final : public Clock
+	{
+	public:
+		RealClock() = default;
+		~RealClock() override = default;
+
+		[[nodiscard]] f64 now() const override;
+		std::optional<f64> sleepUntil(f64 time) override;
+
+		// how long before the time asked for the sleep ends and the spin starts, seconds, can be read from any thread
+		[[nodiscard]] inline f64 slack() const { return m_slack.load(std::memory_order_relaxed); }
+
+	private:
+		static constexpr f64 MaxSlack = 0.5e-3; // the spin never takes longer than this, however badly the sleeps wake up
+
+		// smoothed like a TCP round trip estimate, slack covers the usual lateness and most of its spread,
+		// only the sleeping thread touches these apart from reading m_slack
+		f64 m_lateness = 100e-6;
+		f64 m_deviation = 50e-6;
+		std::atomic<f64> m_slack { 300e-6 };
+
+		// sleeps until now() is about time, possibly a bit after
+		void sleepUntilOs(f64 time) const;
+	};
+}
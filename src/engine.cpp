@@ -4,11 +4,9 @@
 #include "render.h"
 #include "input.h"
 #include "game.h"
-#include <atomic>
-#include <thread>
-#include <chrono>
-#include <cmath>
-#include <algorithm>
+#include "player.h"
+#include "scene.h"
+#include "tick.h"
 #include <memory>
 
 namespace game
@@ -26,95 +24,9 @@ namespace game
 
 			bool m_success;
 		};
-
-		struct GameDataGuard
-		{
-			GameDataGuard()
-			{
-				loadGameData();
-			}
-
-			~GameDataGuard()
-			{
-				destroyGameData();
-			}
-		};
-
-		// changing will wreck npc ai
-		constexpr f64 TicksPerSecond = 64.0;
-		constexpr f64 TickLength = 1.0 / TicksPerSecond;
-
-		class TickThread
-		{
-		public:
-			explicit TickThread(World &world)
-				: m_world(world),
-				  m_thread([this]() { run(); }) {}
-
-			~TickThread()
-			{
-				if(m_thread.joinable()) stop();
-			}
-
-			[[nodiscard]] inline auto lastTick() const { return m_lastTick.load(std::memory_order_acquire); }
-
-			void startCountingTicks()
-			{
-				m_countTicks.store(true, std::memory_order_release);
-			}
-
-			void stop()
-			{
-				m_stop.store(true, std::memory_order_release);
-				m_thread.join();
-			}
-
-		private:
-			World &m_world;
-			std::atomic_bool m_stop { false };
-			std::atomic_bool m_countTicks { false };
-			std::atomic<f64> m_lastTick {};
-			std::thread m_thread;
-
-			void run()
-			{
-				auto time = glfwGetTime();
-				auto prevTime = time;
-
-				u64 ticks = 0;
-
-				while(!m_stop.load(std::memory_order_acquire))
-				{
-					//const auto delta = time - prevTime;
-					prevTime = time;
-					time = glfwGetTime();
-
-					const auto targetTime = time + TickLength;
-
-					m_world.tick(TickLength, ticks);
-					if(m_countTicks.load(std::memory_order_acquire)) ticks++;
-
-					const auto tickTime = glfwGetTime() - time;
-
-					if(tickTime > TickLength) std::cerr << "tick took " << (std::round(tickTime * 100000.0) / 100.0) << " ms, should take max " << (std::round(TickLength * 100000.0) / 100.0) << " ms" << std::endl;
-					else if(tickTime < TickLength)
-					{
-						// Subtract one millisecond to avoid
-						// oversleeping due to scheduler accuracy
-						auto ms = static_cast<u64>(std::floor(std::max(1.0, (TickLength - tickTime) * 1000.0)) - 1.0);
-						std::this_thread::sleep_for(std::chrono::milliseconds(ms));
-
-						// busy sleep for the rest
-						while(glfwGetTime() < targetTime) {}
-					}
-
-					m_lastTick.store(time, std::memory_order_release);
-				}
-			}
-		};
 	}
 
-	int start()
+	int start(const std::string &recordPath)
 	{
 		GlfwInitGuard glfwInitGuard;
 
@@ -136,32 +48,30 @@ namespace game
 
 		Renderer renderer(window, 30.0F);
 
-		GameDataGuard gameDataGuard;
-
 		World world;
 
 		TickThread tickThread(world);
 
 		auto player = std::make_shared<PlayerCar>();
 
+		Scene scene(player);
+
 		world.addEntity(std::make_shared<Track>());
 		world.addEntity(player);
 		world.addEntity(std::make_shared<NpcCar>(0));
 		world.addEntity(std::make_shared<NpcCar>(1));
 		world.addEntity(std::make_shared<NpcCar>(2));
 
+		if(!recordPath.empty()) world.startRecording(recordPath, TicksPerSecond);
+
 		tickThread.startCountingTicks();
 
 		while(!window.shouldClose())
 		{
-			const auto time = glfwGetTime();
-			const auto partialTick = (time - tickThread.lastTick()) * TicksPerSecond - 1.0;
-
-			renderer.beginFrame(player->updateFramePosition(partialTick));
-
-			world.render(renderer, partialTick);
+			// the snapshot and how far to interpolate it have to be for the same tick
+			const auto &snapshot = world.snapshot();
+			scene.render(world, snapshot, renderer, tickThread.partialTick(snapshot.m_time));
 
-			renderer.endFrame();
 			window.update();
 		}
 
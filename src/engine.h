@@ -1,8 +1,10 @@
 #pragma once
 
 #include "types.h"
+#include <string>
 
 namespace game
 {
-	i32 start();
+	// records every car's inputs to recordPath if it isn't empty
+	i32 start(const std::string &recordPath = "");
 }
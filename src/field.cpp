@@ -0,0 +1,224 @@
+#include "field.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+namespace game::util
+{
+	namespace
+	{
+		constexpr f64 Far = 1e20;
+
+		// Felzenszwalb and Huttenlocher's squared distance transform of one row or column, in place
+		void transform(std::vector<f64> &f, std::vector<f64> &d, std::vector<u32> &v, std::vector<f64> &z, u32 n)
+		{
+			u32 k = 0;
+			v[0] = 0;
+			z[0] = -INFINITY;
+			z[1] = INFINITY;
+
+			for(u32 q = 1; q < n; ++q)
+			{
+				auto s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0 * q - 2.0 * v[k]);
+
+				while(s <= z[k])
+				{
+					--k;
+					s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0 * q - 2.0 * v[k]);
+				}
+
+				++k;
+				v[k] = q;
+				z[k] = s;
+				z[k + 1] = INFINITY;
+			}
+
+			k = 0;
+
+			for(u32 q = 0; q < n; ++q)
+			{
+				while(z[k + 1] < q) ++k;
+
+				const auto offset = static_cast<f64>(q) - v[k];
+				d[q] = offset * offset + f[v[k]];
+			}
+
+			std::copy_n(std::cbegin(d), n, std::begin(f));
+		}
+
+		// squared distance in pixels from every pixel to the nearest pixel where mask == target
+		std::vector<f64> squaredDistances(const std::vector<bool> &mask, u32 width, u32 height, bool target)
+		{
+			std::vector<f64> distances(mask.size());
+
+			for(size_t i = 0; i < mask.size(); ++i) distances[i] = mask[i] == target ? 0.0 : Far;
+
+			const auto longest = std::max(width, height);
+			std::vector<f64> f(longest), d(longest), z(longest + 1);
+			std::vector<u32> v(longest);
+
+			for(u32 x = 0; x < width; ++x)
+			{
+				for(u32 y = 0; y < height; ++y) f[y] = distances[x + y * width];
+				transform(f, d, v, z, height);
+				for(u32 y = 0; y < height; ++y) distances[x + y * width] = f[y];
+			}
+
+			for(u32 y = 0; y < height; ++y)
+			{
+				std::copy_n(std::cbegin(distances) + y * width, width, std::begin(f));
+				transform(f, d, v, z, width);
+				std::copy_n(std::cbegin(f), width, std::begin(distances) + y * width);
+			}
+
+			return distances;
+		}
+	}
+
+	DistanceField::DistanceField(const std::vector<bool> &mask, u32 width, u32 height, glm::dvec2 origin, glm::dvec2 pixelSize)
+		: m_width(width), m_height(height),
+		  m_origin(origin),
+		  m_pixelSize(pixelSize),
+		  m_worldPerPixel(std::min(std::abs(pixelSize.x), std::abs(pixelSize.y)))
+	{
+		if(width == 0 || height == 0) return;
+
+		const auto toSolid = squaredDistances(mask, width, height, true);
+		const auto toFree = squaredDistances(mask, width, height, false);
+
+		m_distances.resize(mask.size());
+
+		// the boundary is half a pixel from the centre of the pixels either side of it
+		for(size_t i = 0; i < mask.size(); ++i)
+		{
+			const auto pixels = mask[i] ? -(std::sqrt(toFree[i]) - 0.5) : std::sqrt(toSolid[i]) - 0.5;
+			m_distances[i] = static_cast<f32>(std::clamp(pixels, -Far, Far) * m_worldPerPixel);
+		}
+	}
+
+	glm::dvec2 DistanceField::toPixel(glm::dvec2 point) const
+	{
+		return (point - m_origin) / m_pixelSize - 0.5;
+	}
+
+	f64 DistanceField::at(i32 x, i32 y) const
+	{
+		x = std::clamp(x, 0, static_cast<i32>(m_width) - 1);
+		y = std::clamp(y, 0, static_cast<i32>(m_height) - 1);
+
+		return m_distances[static_cast<u32>(x) + static_cast<u32>(y) * m_width];
+	}
+
+	f64 DistanceField::distance(glm::dvec2 point) const
+	{
+		if(empty()) return INFINITY;
+
+		const auto pixel = toPixel(point);
+		const auto base = glm::floor(pixel);
+		const auto t = pixel - base;
+		const auto x = static_cast<i32>(base.x);
+		const auto y = static_cast<i32>(base.y);
+
+		const auto top = lerp(at(x, y), at(x + 1, y), t.x);
+		const auto bottom = lerp(at(x, y + 1), at(x + 1, y + 1), t.x);
+
+		return lerp(top, bottom, t.y);
+	}
+
+	DistanceField::Sample DistanceField::sample(glm::dvec2 point) const
+	{
+		if(empty()) return { INFINITY, { 0.0, 0.0 } };
+
+		const auto pixel = toPixel(point);
+		const auto base = glm::floor(pixel);
+		const auto t = pixel - base;
+		const auto x = static_cast<i32>(base.x);
+		const auto y = static_cast<i32>(base.y);
+
+		const auto d00 = at(x, y), d10 = at(x + 1, y);
+		const auto d01 = at(x, y + 1), d11 = at(x + 1, y + 1);
+
+		const auto top = lerp(d00, d10, t.x);
+		const auto bottom = lerp(d01, d11, t.x);
+
+		// derivatives of the bilinear interpolation in pixels, then scaled into world units
+		const glm::dvec2 pixelGradient { lerp(d10 - d00, d11 - d01, t.y), bottom - top };
+
+		return { lerp(top, bottom, t.y), pixelGradient / m_pixelSize };
+	}
+
+	bool DistanceField::intersects(const OrientedBoundingBox &box) const
+	{
+		if(empty()) return false;
+
+		const auto &geometry = box.geometry();
+		const auto centre = distance(box.m_position);
+
+		// nothing solid within the bounding circle, this is most calls
+		if(centre > geometry.m_radius) return false;
+		if(centre <= 0.0) return true;
+
+		// walks a line, jumping ahead by the distance to the nearest wall since nothing can be closer than that
+		// a quarter pixel minimum step bounds the number of lookups by the length of the line
+		const auto minStep = m_worldPerPixel / 4.0;
+
+		const auto hitAlong = [this, minStep](glm::dvec2 from, glm::dvec2 direction, f64 length)
+		{
+			for(f64 travelled = 0.0;; )
+			{
+				const auto d = distance(from + direction * std::min(travelled, length));
+				if(d <= 0.0) return true;
+
+				if(travelled >= length) return false;
+				travelled += std::max(d, minStep);
+			}
+		};
+
+		// the outline, then lines along the long sides half a pixel apart, a solid pixel is a pixel across so one of them
+		// goes through any the outline misses, even a thin wall that's all inside the box
+		for(size_t edge = 0; edge < 4; ++edge)
+		{
+			if(hitAlong(geometry.m_vertices[edge], geometry.m_axes[edge % 2] * (edge < 2 ? 1.0 : -1.0), geometry.m_lengths[edge % 2])) return true;
+		}
+
+		const auto along = geometry.m_lengths[0] >= geometry.m_lengths[1] ? 0 : 1;
+		const auto across = 1 - along;
+		const auto rows = static_cast<u32>(std::ceil(geometry.m_lengths[across] / (m_worldPerPixel / 2.0)));
+
+		// both sides from vertex 0 run along the axes, one to vertex 1 and the other to vertex 3
+		for(u32 row = 1; row < rows; ++row)
+		{
+			const auto from = geometry.m_vertices[0] + geometry.m_axes[across] * (geometry.m_lengths[across] * row / rows);
+			if(hitAlong(from, geometry.m_axes[along], geometry.m_lengths[along])) return true;
+		}
+
+		return false;
+	}
+
+	std::optional<Contact> DistanceField::contact(const OrientedBoundingBox &box) const
+	{
+		if(!intersects(box)) return std::nullopt;
+
+		const auto &vertices = box.geometry().m_vertices;
+
+		const std::array<glm::dvec2, 9> points {
+			vertices[0], vertices[1], vertices[2], vertices[3],
+			(vertices[0] + vertices[1]) / 2.0, (vertices[1] + vertices[2]) / 2.0, (vertices[2] + vertices[3]) / 2.0, (vertices[3] + vertices[0]) / 2.0,
+			box.m_position
+		};
+
+		auto deepest = sample(points[0]);
+
+		for(size_t i = 1; i < points.size(); ++i)
+		{
+			if(const auto point = sample(points[i]); point.m_distance < deepest.m_distance) deepest = point;
+		}
+
+		const auto length = glm::length(deepest.m_gradient);
+		if(length == 0.0) return std::nullopt;
+
+		return Contact { deepest.m_gradient / length, std::max(0.0, -deepest.m_distance) };
+	}
+}
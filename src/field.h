@@ -0,0 +1,52 @@
+#pragma once
+
+#include "types.h"
+#include "util.h"
+#include <vector>
+
+namespace game::util
+{
+	// signed distance to the nearest solid pixel of a mask, negative inside solid pixels
+	// a box can be tested against it with a few lookups however many walls there are
+	class DistanceField
+	{
+	public:
+		struct Sample
+		{
+			f64 m_distance;
+			glm::dvec2 m_gradient; // points away from the nearest wall, about unit length
+		};
+
+		DistanceField() = default;
+
+		// mask is width * height, row by row, true where solid
+		// origin is the world position of the corner of pixel (0, 0) and pixelSize can be negative to flip an axis
+		DistanceField(const std::vector<bool> &mask, u32 width, u32 height, glm::dvec2 origin, glm::dvec2 pixelSize);
+		~DistanceField() = default;
+
+		[[nodiscard]] inline bool empty() const { return m_distances.empty(); }
+
+		// bilinearly interpolated, points outside the mask use the nearest edge pixel
+		[[nodiscard]] f64 distance(glm::dvec2 point) const;
+		[[nodiscard]] Sample sample(glm::dvec2 point) const;
+
+		// true if any part of the box's outline or of lines across it half a pixel apart is in a solid pixel, or its centre is,
+		// so only a wall poking less than about half a pixel into the box between the lines can be missed
+		[[nodiscard]] bool intersects(const OrientedBoundingBox &box) const;
+
+		// the deepest of the box's corners, edge midpoints and centre, pushed out along the gradient there
+		// approximate as a wall can poke into an edge between the points, nothing if the box doesn't intersect
+		[[nodiscard]] std::optional<Contact> contact(const OrientedBoundingBox &box) const;
+
+	private:
+		u32 m_width = 0, m_height = 0;
+		glm::dvec2 m_origin { 0.0 };
+		glm::dvec2 m_pixelSize { 1.0 };
+		f64 m_worldPerPixel = 1.0; // world distance of one pixel step
+		std::vector<f32> m_distances; // world units, at pixel centres
+
+		// continuous pixel coordinates of a world point, whole numbers are pixel centres
+		[[nodiscard]] glm::dvec2 toPixel(glm::dvec2 point) const;
+		[[nodiscard]] inline f64 at(i32 x, i32 y) const;
+	};
+}
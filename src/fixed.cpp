@@ -0,0 +1,176 @@
+#include "fixed.h"
+#include <array>
+#include <algorithm>
+#include <utility>
+
+namespace game::util
+{
+	namespace
+	{
+		constexpr u32 CordicSteps = 32;
+
+		// atan(2^-i) in Q32.32, past the first few it's 2^-i to within half a step
+		constexpr std::array<i64, CordicSteps> ArcTangents {
+			3373259426, 1991351318, 1052175346, 534100635, 268086748, 134174063, 67103403, 33553749,
+			16777131, 8388597, 4194303, 2097152, 1048576, 524288, 262144, 131072,
+			65536, 32768, 16384, 8192, 4096, 2048, 1024, 512,
+			256, 128, 64, 32, 16, 8, 4, 2
+		};
+
+		// every CORDIC step makes the vector longer, this is 1 over how much longer all of them make it
+		constexpr i64 CordicGain = 2608131496;
+
+		constexpr i64 HalfPi = 6746518852;
+		constexpr i64 PiRaw = 13493037705;
+		constexpr i64 TwoPi = 26986075409;
+
+		// x + iy rotated by angle, which must be within a quarter turn of 0
+		void rotate(i64 &x, i64 &y, i64 angle)
+		{
+			for(u32 i = 0; i < CordicSteps; ++i)
+			{
+				const auto dx = y >> i;
+				const auto dy = x >> i;
+
+				if(angle >= 0)
+				{
+					x -= dx;
+					y += dy;
+					angle -= ArcTangents[i];
+				}
+				else
+				{
+					x += dx;
+					y -= dy;
+					angle += ArcTangents[i];
+				}
+			}
+		}
+
+		// cosine and sine of angle as x and y
+		std::pair<Fixed, Fixed> cosSin(Fixed angle)
+		{
+			// into -pi to pi, then into a quarter turn of 0 by turning half way round
+			auto reduced = angle.raw() % TwoPi;
+			if(reduced > PiRaw) reduced -= TwoPi;
+			else if(reduced < -PiRaw) reduced += TwoPi;
+
+			auto flip = false;
+
+			if(reduced > HalfPi)
+			{
+				reduced -= PiRaw;
+				flip = true;
+			}
+			else if(reduced < -HalfPi)
+			{
+				reduced += PiRaw;
+				flip = true;
+			}
+
+			i64 x = CordicGain, y = 0;
+			rotate(x, y, reduced);
+
+			const auto cos = Fixed::fromRaw(x), sin = Fixed::fromRaw(y);
+			return flip ? std::pair { -cos, -sin } : std::pair { cos, sin };
+		}
+
+		u32 bitLength(u64 value)
+		{
+			u32 bits = 0;
+
+			while(value != 0)
+			{
+				++bits;
+				value >>= 1;
+			}
+
+			return bits;
+		}
+	}
+
+	// newton's method from above, stops as soon as a step doesn't get any smaller
+	Fixed sqrt(Fixed value)
+	{
+		if(value <= Fixed()) return Fixed();
+
+		// sqrt(raw / One) * One is sqrt(raw) * 2^16, and 2^(bits / 2 rounded up) is at least sqrt(raw)
+		auto root = Fixed::fromRaw(i64 { 1 } << (Fixed::FractionBits / 2 + (bitLength(static_cast<u64>(value.raw())) + 1) / 2));
+
+		while(true)
+		{
+			const auto next = Fixed::fromRaw((root.raw() + (value / root).raw()) / 2);
+			if(next >= root) return root;
+			root = next;
+		}
+	}
+
+	Fixed sin(Fixed angle)
+	{
+		return cosSin(angle).second;
+	}
+
+	Fixed cos(Fixed angle)
+	{
+		return cosSin(angle).first;
+	}
+
+	// rotates (x, y) onto the x axis, adding up how far it turned
+	Fixed atan2(Fixed y, Fixed x)
+	{
+		if(x == Fixed() && y == Fixed()) return Fixed();
+
+		// start half a turn round if it's on the left, the steps only cover a quarter turn either way,
+		// the negation saturates so lowest() comes out as max() rather than overflowing
+		i64 angle = 0;
+
+		if(x < Fixed())
+		{
+			angle = y < Fixed() ? -PiRaw : PiRaw;
+			x = -x;
+			y = -y;
+		}
+
+		auto vx = x.raw(), vy = y.raw();
+
+		// scale up small vectors so the shifts keep their precision, leaving room for the gain
+		const auto largest = std::max(static_cast<u64>(vx), vy < 0 ? 0 - static_cast<u64>(vy) : static_cast<u64>(vy));
+		const auto bits = bitLength(largest);
+
+		if(bits < 60)
+		{
+			vx *= i64 { 1 } << (60 - bits);
+			vy *= i64 { 1 } << (60 - bits);
+		}
+		else
+		{
+			vx >>= bits - 60;
+			vy >>= bits - 60;
+		}
+
+		for(u32 i = 0; i < CordicSteps; ++i)
+		{
+			const auto dx = vy >> i;
+			const auto dy = vx >> i;
+
+			if(vy > 0)
+			{
+				vx += dx;
+				vy -= dy;
+				angle += ArcTangents[i];
+			}
+			else
+			{
+				vx -= dx;
+				vy += dy;
+				angle -= ArcTangents[i];
+			}
+		}
+
+		// a vector on the left turned the long way round, bring it back into -pi to pi
+		if(angle > PiRaw) angle -= TwoPi;
+		else if(angle < -PiRaw) angle += TwoPi;
+
+		return Fixed::fromRaw(angle);
+	}
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "types.h"
+#include "util.h"
+#include <limits>
+
+namespace game::util
+{
+	// a signed Q32.32 fixed point number, all of its maths is integer maths so it comes out the same
+	// on every machine, compiler and set of flags, unlike f64 with a libm's trig
+	class Fixed
+	{
+	public:
+		static constexpr u32 FractionBits = 32;
+		static constexpr i64 One = i64 { 1 } << FractionBits;
+
+		// trivial so glm's vectors can hold it, Fixed() and Fixed {} are still 0
+		Fixed() = default;
+
+		// rounds to the nearest step, converting doesn't touch libm so it's exact everywhere too
+		constexpr explicit Fixed(f64 value) : m_raw(static_cast<i64>(value * static_cast<f64>(One) + (value < 0.0 ? -0.5 : 0.5))) {}
+
+		[[nodiscard]] static constexpr Fixed fromRaw(i64 raw)
+		{
+			Fixed fixed {};
+			fixed.m_raw = raw;
+			return fixed;
+		}
+
+		[[nodiscard]] constexpr i64 raw() const { return m_raw; }
+
+		constexpr explicit operator f64() const { return static_cast<f64>(m_raw) / static_cast<f64>(One); }
+
+		// like divide these saturate instead of overflowing, which would be undefined and could differ between machines
+		[[nodiscard]] constexpr Fixed operator-() const { return fromRaw(m_raw == std::numeric_limits<i64>::min() ? std::numeric_limits<i64>::max() : -m_raw); }
+
+		[[nodiscard]] friend constexpr Fixed operator+(Fixed a, Fixed b) { return fromRaw(add(a.m_raw, b.m_raw)); }
+		[[nodiscard]] friend constexpr Fixed operator-(Fixed a, Fixed b) { return fromRaw(subtract(a.m_raw, b.m_raw)); }
+		[[nodiscard]] friend constexpr Fixed operator*(Fixed a, Fixed b) { return fromRaw(multiply(a.m_raw, b.m_raw)); }
+		[[nodiscard]] friend constexpr Fixed operator/(Fixed a, Fixed b) { return fromRaw(divide(a.m_raw, b.m_raw)); }
+
+		constexpr Fixed &operator+=(Fixed other) { return *this = *this + other; }
+		constexpr Fixed &operator-=(Fixed other) { return *this = *this - other; }
+		constexpr Fixed &operator*=(Fixed other) { return *this = *this * other; }
+		constexpr Fixed &operator/=(Fixed other) { return *this = *this / other; }
+
+		[[nodiscard]] friend constexpr bool operator==(Fixed a, Fixed b) { return a.m_raw == b.m_raw; }
+		[[nodiscard]] friend constexpr bool operator!=(Fixed a, Fixed b) { return a.m_raw != b.m_raw; }
+		[[nodiscard]] friend constexpr bool operator<(Fixed a, Fixed b) { return a.m_raw < b.m_raw; }
+		[[nodiscard]] friend constexpr bool operator<=(Fixed a, Fixed b) { return a.m_raw <= b.m_raw; }
+		[[nodiscard]] friend constexpr bool operator>(Fixed a, Fixed b) { return a.m_raw > b.m_raw; }
+		[[nodiscard]] friend constexpr bool operator>=(Fixed a, Fixed b) { return a.m_raw >= b.m_raw; }
+
+	private:
+		i64 m_raw;
+
+#if defined(__SIZEOF_INT128__)
+		__extension__ typedef __int128 Wide;
+#endif
+
+		// wraps in unsigned, where it's defined, and saturates if the sign came out different to both operands
+		[[nodiscard]] static constexpr i64 add(i64 a, i64 b)
+		{
+			const auto sum = static_cast<i64>(static_cast<u64>(a) + static_cast<u64>(b));
+			if(((a ^ sum) & (b ^ sum)) < 0) return a < 0 ? std::numeric_limits<i64>::min() : std::numeric_limits<i64>::max();
+			return sum;
+		}
+
+		// saturates if a and b had different signs and the difference has b's
+		[[nodiscard]] static constexpr i64 subtract(i64 a, i64 b)
+		{
+			const auto difference = static_cast<i64>(static_cast<u64>(a) - static_cast<u64>(b));
+			if(((a ^ b) & (a ^ difference)) < 0) return a < 0 ? std::numeric_limits<i64>::min() : std::numeric_limits<i64>::max();
+			return difference;
+		}
+
+		// a * b / One rounded to nearest, through a 128 bit product
+		[[nodiscard]] static constexpr i64 multiply(i64 a, i64 b)
+		{
+#if defined(__SIZEOF_INT128__)
+			return static_cast<i64>((static_cast<Wide>(a) * b + (i64 { 1 } << (FractionBits - 1))) >> FractionBits);
+#else
+			// 32 bit halves for compilers without a 128 bit type, the same rounding as above
+			const auto negative = (a < 0) != (b < 0);
+			const auto ua = a < 0 ? 0 - static_cast<u64>(a) : static_cast<u64>(a);
+			const auto ub = b < 0 ? 0 - static_cast<u64>(b) : static_cast<u64>(b);
+
+			const auto low = (ua & 0xFFFFFFFF) * (ub & 0xFFFFFFFF);
+			const auto middleA = (ua >> 32) * (ub & 0xFFFFFFFF);
+			const auto middleB = (ua & 0xFFFFFFFF) * (ub >> 32);
+			const auto high = (ua >> 32) * (ub >> 32);
+
+			const auto middle = (low >> 32) + (middleA & 0xFFFFFFFF) + (middleB & 0xFFFFFFFF);
+			auto productHigh = high + (middleA >> 32) + (middleB >> 32) + (middle >> 32);
+			auto productLow = (middle << 32) | (low & 0xFFFFFFFF);
+
+			// rounding half up on the signed product is rounding half down on its magnitude when it's negative
+			const auto half = (u64 { 1 } << (FractionBits - 1)) - (negative ? 1 : 0);
+			productLow += half;
+			if(productLow < half) ++productHigh;
+
+			const auto magnitude = (productHigh << (64 - FractionBits)) | (productLow >> FractionBits);
+			return negative ? static_cast<i64>(0 - magnitude) : static_cast<i64>(magnitude);
+#endif
+		}
+
+		// a * One / b rounded towards 0, through a 128 bit dividend, saturated to the range of i64 when the quotient
+		// doesn't fit, dividing by a speed of a few steps is common in sweeps and must not wrap round to a small number
+		[[nodiscard]] static constexpr i64 divide(i64 a, i64 b)
+		{
+#if defined(__SIZEOF_INT128__)
+			const auto quotient = static_cast<Wide>(a) * One / b;
+
+			if(quotient > std::numeric_limits<i64>::max()) return std::numeric_limits<i64>::max();
+			if(quotient < std::numeric_limits<i64>::min()) return std::numeric_limits<i64>::min();
+
+			return static_cast<i64>(quotient);
+#else
+			// long division a bit at a time for compilers without a 128 bit type
+			const auto negative = (a < 0) != (b < 0);
+			const auto ua = a < 0 ? 0 - static_cast<u64>(a) : static_cast<u64>(a);
+			const auto ub = b < 0 ? 0 - static_cast<u64>(b) : static_cast<u64>(b);
+
+			u64 dividendHigh = ua >> (64 - FractionBits), dividendLow = ua << FractionBits;
+			u64 quotient = 0, remainder = 0;
+			bool overflow = false; // a set bit was shifted out of the top of quotient
+
+			for(u32 bit = 0; bit < 128; ++bit)
+			{
+				const auto carry = remainder >> 63;
+				remainder = (remainder << 1) | (dividendHigh >> 63);
+				dividendHigh = (dividendHigh << 1) | (dividendLow >> 63);
+				dividendLow <<= 1;
+				overflow |= (quotient >> 63) != 0;
+				quotient <<= 1;
+
+				if(carry != 0 || remainder >= ub)
+				{
+					remainder -= ub;
+					quotient |= 1;
+				}
+			}
+
+			// the magnitude of lowest() is one more than max()
+			const auto limit = static_cast<u64>(std::numeric_limits<i64>::max()) + (negative ? 1 : 0);
+			if(overflow || quotient > limit) return negative ? std::numeric_limits<i64>::min() : std::numeric_limits<i64>::max();
+
+			return negative ? static_cast<i64>(0 - quotient) : static_cast<i64>(quotient);
+#endif
+		}
+	};
+}
+
+namespace std
+{
+	template <>
+	class numeric_limits<game::util::Fixed>
+	{
+	public:
+		static constexpr bool is_specialized = true;
+		static constexpr bool is_signed = true;
+		static constexpr bool is_integer = false;
+		static constexpr bool is_exact = true;
+		static constexpr bool has_infinity = false;
+		static constexpr bool has_quiet_NaN = false;
+		static constexpr bool has_signaling_NaN = false;
+		static constexpr bool is_iec559 = false;
+		static constexpr bool is_bounded = true;
+		static constexpr bool is_modulo = false;
+		static constexpr int radix = 2;
+		static constexpr int digits = 63;
+
+		static constexpr game::util::Fixed min() { return game::util::Fixed::fromRaw(1); }
+		static constexpr game::util::Fixed lowest() { return game::util::Fixed::fromRaw(std::numeric_limits<game::i64>::min()); }
+		static constexpr game::util::Fixed max() { return game::util::Fixed::fromRaw(std::numeric_limits<game::i64>::max()); }
+		static constexpr game::util::Fixed epsilon() { return game::util::Fixed::fromRaw(1); }
+		static constexpr game::util::Fixed round_error() { return game::util::Fixed::fromRaw(game::util::Fixed::One / 2); }
+		static constexpr game::util::Fixed infinity() { return {}; }
+		static constexpr game::util::Fixed quiet_NaN() { return {}; }
+		static constexpr game::util::Fixed signaling_NaN() { return {}; }
+		static constexpr game::util::Fixed denorm_min() { return {}; }
+	};
+}
+
+namespace game::util
+{
+	// found by argument dependent lookup, so generic code calls these unqualified next to a using std::abs and friends
+	[[nodiscard]] constexpr inline Fixed abs(Fixed value) { return value < Fixed() ? -value : value; }
+	[[nodiscard]] Fixed sqrt(Fixed value);
+
+	// CORDIC over a table of arctangents, accurate to a few steps of the last bit
+	[[nodiscard]] Fixed sin(Fixed angle);
+	[[nodiscard]] Fixed cos(Fixed angle);
+	[[nodiscard]] Fixed atan2(Fixed y, Fixed x);
+
+	using FixedOrientedBoundingBox = BasicOrientedBoundingBox<Fixed>;
+
+	extern template struct BasicOrientedBoundingBox<Fixed>;
+}
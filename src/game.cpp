@@ -1,66 +1,22 @@
 #include "game.h"
 #include <cmath>
 #include <algorithm>
-#include "config.h"
 #include <iostream>
 #include "assets.h"
-#include <sstream>
+#include "replay.h"
+#include "bitmap.h"
+#include "physics.h"
 #include <tuple>
+#include <iterator>
+#include <utility>
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
 
 namespace game
 {
 	namespace
 	{
-		namespace physics
-		{
-			constexpr auto Gravity = 9.80665;
-			constexpr auto AirResistance = 2.5;
-			constexpr auto BounceFactor = -0.6;
-
-			namespace car
-			{
-				constexpr auto Mass = 1200.0;
-				constexpr auto InertiaScale = 1.0;
-				constexpr auto CentreOfGravityToFrontAxle = 1.25;
-				constexpr auto CentreOfGravityToRearAxle = 1.25;
-				constexpr auto CentreOfGravityToGround = 0.55;
-				constexpr auto TyreGrip = 2.0;
-				constexpr auto LockGrip = 0.7;
-				constexpr auto EngineForce = 8000.0;
-				constexpr auto EngineReverseScale = 0.6;
-				constexpr auto BrakeForce = 12000.0;
-				constexpr auto HandbrakeForce = 4800.0;
-				constexpr auto WeightTransfer = 0.2;
-				constexpr auto CornerStiffnessFront = 5.0;
-				constexpr auto CornerStiffnessRear = 5.2;
-				constexpr auto RollResistance = 8.0;
-
-				constexpr auto Inertia = Mass * InertiaScale;
-				constexpr auto WheelBase = CentreOfGravityToFrontAxle + CentreOfGravityToRearAxle;
-				constexpr auto AxleLoadRatioFront = CentreOfGravityToRearAxle / WheelBase;
-				constexpr auto AxleLoadRatioRear = CentreOfGravityToFrontAxle / WheelBase;
-				constexpr auto EngineReverseForce = -EngineForce * EngineReverseScale;
-			}
-		}
-
-		void drawHitbox(Renderer &renderer, const util::OrientedBoundingBox &hitbox, const glm::vec3 tint = { 0.0F, 1.0F, 0.0F })
-		{
-			RenderableQuad hitboxSprite {};
-
-			hitboxSprite.m_position = hitbox.m_position;
-			hitboxSprite.m_rotation = hitbox.m_rotation;
-			hitboxSprite.m_scale = hitbox.m_size;
-			hitboxSprite.m_tint = tint;
-
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-			renderer.drawQuad(hitboxSprite);
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		}
-
-		constexpr auto DrawHitboxes = false; //change to make the hitboxes appear
-
-		constexpr glm::dvec2 PlayerStartPos { -28.7, 2.0 };
-		constexpr std::array NpcStartPos { glm::dvec2 { -26.5, 2.0 }, glm::dvec2 { -28.7, -1.0 }, glm::dvec2 { -26.5, -1.0 } };
+		constexpr std::array<glm::dvec2, NpcCarCount> NpcStartPos { glm::dvec2 { -26.5, 2.0 }, glm::dvec2 { -28.7, -1.0 }, glm::dvec2 { -26.5, -1.0 } };
 
 		const std::vector<std::tuple<u64, size_t, bool>> NpcInputs {
 			{ 0, Car::Accelerate, true },
@@ -89,286 +45,317 @@ namespace game
 		};
 		 */
 
+		// about the size of a car, so a car's hitbox covers a few cells
+		constexpr auto TrackGridCellSize = 2.0;
+
+		// covers the difference between fixed point bounds and their f64 conversions, so no candidate is missed
+		constexpr auto FixedQueryPadding = 1e-6;
+
 		//const std::array InputNames { "accelerate", "reverse", "brake", "left", "right", "handbrake" };
+	}
 
-		struct GameData
-		{
-			GameData()
-				: m_trackTexture("track"),
-				  m_playerCarTexture("car"),
-				  m_npcCarTexture("car2"),
-				  m_startingLineHitbox({ -27.75, 15.35 / 3.0 }, 0.0, { 6.0, 3.0 }) {}
+	f64 Entity::timeOfImpact(const util::OrientedBoundingBox &hitbox, glm::dvec2 displacement) const
+	{
+		const auto distance = glm::length(displacement);
+		const auto step = std::min(hitbox.m_size.x, hitbox.m_size.y) / 2.0;
+		const auto steps = std::max(1.0, std::ceil(distance / step));
 
-			~GameData() = default;
+		auto moved = hitbox;
+		f64 clear = 0.0;
 
-			void drawStartLineHitbox(Renderer &renderer) const
-			{
-				drawHitbox(renderer, m_startingLineHitbox, { 1.0, 0.0, 1.0 });
-			}
+		for(f64 i = 0.0; i <= steps; ++i)
+		{
+			auto t = i / steps;
+			moved.m_position = hitbox.m_position + displacement * t;
 
-			//this is called when a car finishes a lap
-			void finishLap(Car &car, f64 time)
+			if(intersects(moved))
 			{
-				// this is called with -1 as the time the first time cars pass the start line
-				if(time < 0.0) return;
+				if(i == 0.0) return 0.0;
 
-				std::cout << "car finished with time " << time << " seconds" << std::endl;
-
-				if(time < m_fastestTime)
+				// narrow down where between the last clear step and this one it starts touching
+				for(u32 j = 0; j < 16; ++j)
 				{
-					if(m_fastestCar) m_slowerCars.push_back(m_fastestCar);
-
-					m_fastestCar = &car;
-					m_fastestTime = time;
+					const auto middle = (clear + t) / 2.0;
+					moved.m_position = hitbox.m_position + displacement * middle;
 
-					std::cout << "^ fastest time" << std::endl;
+					if(intersects(moved)) t = middle;
+					else clear = middle;
 				}
 
-				// 4 cars in the race
-				if(++m_finishedCars == 4)
-				{
-					m_fastestCar->winRace();
-
-					for(auto *slowCar : m_slowerCars)
-					{
-						slowCar->loseRace();
-					}
-				}
+				return t;
 			}
 
-			gl::SingleTexture m_trackTexture, m_playerCarTexture, m_npcCarTexture;
-			util::OrientedBoundingBox m_startingLineHitbox;
-
-			u32 m_finishedCars = 0;
-
-			Car *m_fastestCar = nullptr;
-			std::vector<Car *> m_slowerCars;
-			f64 m_fastestTime = INFINITY;
-		};
-
-		std::unique_ptr<GameData> s_data { nullptr };
-	}
-
-	void loadGameData()
-	{
-		s_data = std::make_unique<GameData>();
-	}
+			clear = t;
+		}
 
-	void destroyGameData()
-	{
-		s_data.reset();
+		return INFINITY;
 	}
 
-	Track::Track()
+	Track::Track(TrackCollision collision)
+		: m_collision(collision)
 	{
-		m_sprite.m_scale = { 64.0, 36.0 };
-		m_sprite.m_textureOverride = &s_data->m_trackTexture;
-
 		auto imageData = assets::loadImage("collide");
 
-		//takes collide.png and generates hitboxes on the track based on it
 		if(imageData)
 		{
-			u32 x = 0;
-			u32 y = 0;
+			const auto mask = util::RowBitmap::fromAlpha(reinterpret_cast<const u32 *>(imageData->m_data), imageData->m_width, imageData->m_height);
 
-			std::vector<bool> mergedMask;
-			mergedMask.resize(imageData->m_width * imageData->m_height);
-
-			while(true)
+			if(collision == TrackCollision::DistanceField)
 			{
-				glm::uvec2 size { 1, 1 };
+				std::vector<bool> solid(imageData->m_width * imageData->m_height);
 
-				// if the pixel is opaque and not already in a different hitbox,
-				// start trying to create a hitbox
-				if((imageData->pixelAt(x, y) >> 24) != 0 && !mergedMask[x + y * imageData->m_width])
+				for(u32 y = 0; y < imageData->m_height; ++y)
 				{
-					glm::uvec2 pos { x, y };
-
-					// loop through all rows
-					for(u32 ny = y; ny < imageData->m_height; ++ny)
-					{
-						u32 currentWidth = 0;
-
-						// loop through all pixels on the row
-						for(u32 nx = x; nx < imageData->m_width; ++nx)
-						{
-							// if the pixel is opaque and not already in a different hitbox,
-							// increment the number of colliding pixels on this row
-							if((imageData->pixelAt(nx, ny) >> 24) != 0 && !mergedMask[nx + ny * imageData->m_width]) ++currentWidth;
-							else break;
-						}
-
-						// if this is the first row, then it is the max width of this hitbox
-						if(ny == y) size.x = currentWidth;
-						// otherwise, continue downwards if the row is long enough
-						else if(currentWidth >= size.x) ++size.y;
-						// otherwise the hitbox is as big as it can be
-						else break;
-					}
-
-					// mark all pixels we've added
-					for(u32 nx = pos.x; nx < pos.x + size.x; ++nx)
-					{
-						for(u32 ny = pos.y; ny < pos.y + size.y; ++ny)
-						{
-							mergedMask[nx + ny * imageData->m_width] = true;
-						}
-					}
+					for(u32 x = 0; x < imageData->m_width; ++x) solid[x + y * imageData->m_width] = mask.at(x, y);
+				}
+
+				// the same transform into world coordinates as the hitboxes below
+				m_field = util::DistanceField(solid, imageData->m_width, imageData->m_height, { -1920.0 / 60.0, 1080.0 / 60.0 }, { 16.0 / 60.0, -16.0 / 60.0 });
+			}
+			//takes collide.png and generates hitboxes on the track based on it
+			else
+			{
+				const auto rectangles = mask.mergeRectangles();
+				m_hitboxes.reserve(rectangles.size());
 
+				for(const auto &[pos, size] : rectangles)
+				{
 					// transform the hitbox into world coordinates
 					glm::dvec2 hitboxCentre { ((pos.x + size.x / 2.0) * 16.0 - 1920.0) / 60.0, ((pos.y + size.y / 2.0) * 16.0 - 1080.0) / -60.0 };
 					glm::dvec2 hitboxSize { static_cast<f64>(size.x) / 3.75, static_cast<f64>(size.y) / 3.75 };
 					m_hitboxes.emplace_back(hitboxCentre, 0.0, hitboxSize);
 				}
-
-				// move right by the size of the line (or 1), continuing to the next
-				// line if we're at the end of this row or stopping if we're at the
-				// bottom of the image
-				if((x += size.x) >= imageData->m_width)
-				{
-					x = 0;
-					if(++y >= imageData->m_height) break;
-				}
 			}
 		}
 		else std::cerr << "Failed to load track collision" << std::endl;
+
+		buildColliders();
 	}
 
-	void Track::tick(World &world, f64 delta, u64 tick)
+	void Track::addColliders(const std::vector<util::OrientedBoundingBox> &colliders)
 	{
-		//
+		m_hitboxes.insert(std::end(m_hitboxes), std::cbegin(colliders), std::cend(colliders));
+		buildColliders();
 	}
- //draws track hitboxes as well as track if it's enabled
-	void Track::render(Renderer &renderer, f64 partialTick)
+
+	void Track::buildColliders()
 	{
-		renderer.drawQuad(m_sprite);
+		if(m_collision == TrackCollision::Hitboxes) m_grid = util::HitboxGrid(m_hitboxes, TrackGridCellSize);
+		else m_bvh = util::HitboxBvh(m_hitboxes);
 
-		if constexpr(DrawHitboxes)
+		m_fixedHitboxes.clear();
+		m_fixedHitboxes.reserve(m_hitboxes.size());
+
+		for(const auto &hitbox : m_hitboxes)
 		{
-			for(const auto &hitbox : m_hitboxes)
-			{
-				drawHitbox(renderer, hitbox);
-			}
+			m_fixedHitboxes.emplace_back(glm::vec<2, util::Fixed>(hitbox.m_position), util::Fixed(hitbox.m_rotation), glm::vec<2, util::Fixed>(hitbox.m_size));
 		}
 	}
 
-	// returns true if the hitbox collides with the track
-	bool Track::intersects(const util::OrientedBoundingBox &hitbox) const
+	template <typename Test>
+	bool Track::anyFixed(const util::BasicBounds<util::Fixed> &bounds, Test &&test) const
 	{
-		return std::any_of(std::cbegin(m_hitboxes), std::cend(m_hitboxes), [&hitbox](const util::OrientedBoundingBox &box) { return hitbox.intersects(box); });
+		const util::Bounds padded { glm::dvec2(bounds.m_min) - FixedQueryPadding, glm::dvec2(bounds.m_max) + FixedQueryPadding };
+
+		if(m_collision == TrackCollision::Hitboxes) return m_grid.any(padded, test);
+		return m_bvh.any(padded, test);
 	}
 
-	Car::Car()
+	void Track::tick([[maybe_unused]] World &world, [[maybe_unused]] f64 delta, [[maybe_unused]] u64 tick)
 	{
-		m_hitbox.m_size = { 2.1, 1.3 };
-		m_hitbox.m_rotation = m_rotation;
+		//
+	}
+
+	f64 Track::timeOfImpact(const util::OrientedBoundingBox &hitbox, glm::dvec2 displacement) const
+	{
+		if(m_collision == TrackCollision::DistanceField) return Entity::timeOfImpact(hitbox, displacement);
+
+		auto moved = hitbox;
+		moved.m_position += displacement;
+
+		const auto from = hitbox.bounds();
+		const auto to = moved.bounds();
+
+		f64 impact = INFINITY;
+
+		const util::Bounds swept { glm::min(from.m_min, to.m_min), glm::max(from.m_max, to.m_max) };
+		const auto visit = [this, &hitbox, displacement, &impact](u32 box) { impact = std::min(impact, hitbox.sweep(m_hitboxes[box], displacement)); };
 
-		m_sprite.m_scale = { 3.0, 1.6 };
+		if(m_collision == TrackCollision::Hitboxes) m_grid.forEach(swept, visit);
+		else m_bvh.forEach(swept, visit);
+
+		return impact;
 	}
 
-	void Car::tick(World &world, f64 delta, u64 tick)
+	std::optional<Contact> Track::contact(const util::OrientedBoundingBox &hitbox) const
 	{
-		updateInputs(tick);
+		std::optional<util::Contact> deepest;
+
+		const auto keepDeepest = [&deepest](const std::optional<util::Contact> &contact)
+		{
+			if(contact && (!deepest || contact->m_depth > deepest->m_depth)) deepest = contact;
+		};
 
-		const auto steerAmount = 1.0 - std::min(m_absoluteVelocity, 250.0) / 280.0;
+		const auto visit = [this, &hitbox, &keepDeepest](u32 box) { keepDeepest(hitbox.contact(m_hitboxes[box])); };
 
-		auto steer = 0.0;
+		if(m_collision == TrackCollision::Hitboxes) m_grid.forEach(hitbox.bounds(), visit);
+		else m_bvh.forEach(hitbox.bounds(), visit);
 
-		if(m_inputs[Left]) steer += steerAmount;
-		if(m_inputs[Right]) steer -= steerAmount;
+		if(m_collision == TrackCollision::DistanceField) keepDeepest(m_field.contact(hitbox));
 
+		if(!deepest) return std::nullopt;
+
+		return Contact { *deepest, this };
+	}
+
+	// returns true if the hitbox collides with the track
+	bool Track::intersects(const util::OrientedBoundingBox &hitbox) const
+	{
+		switch(m_collision)
 		{
-			std::unique_lock lock(m_updateLock);
+		case TrackCollision::Hitboxes: return m_grid.intersects(hitbox);
+		case TrackCollision::Bvh: return m_bvh.intersects(hitbox);
+		case TrackCollision::DistanceField: return m_field.intersects(hitbox) || m_bvh.intersects(hitbox);
+		}
 
-			m_prevPosition = m_position;
-			m_prevRotation = m_rotation;
+		return false;
+	}
 
-			// Marco Monster's car physics model, with reversing
-			const auto s = std::sin(m_rotation);
-			const auto c = std::cos(m_rotation);
+	bool Track::intersects(const util::FixedOrientedBoundingBox &hitbox) const
+	{
+		return anyFixed(hitbox.bounds(), [this, &hitbox](u32 box) { return hitbox.intersects(m_fixedHitboxes[box]); });
+	}
 
-			const glm::dvec2 localVelocity { c * m_velocity.x + s * m_velocity.y, c * m_velocity.y - s * m_velocity.x };
+	util::Fixed Track::timeOfImpact(const util::FixedOrientedBoundingBox &hitbox, glm::vec<2, util::Fixed> displacement) const
+	{
+		auto moved = hitbox;
+		moved.m_position += displacement;
 
-			const auto axleLoadFront = physics::car::Mass * (physics::car::AxleLoadRatioFront * physics::Gravity - physics::car::WeightTransfer * m_localAccel.x * physics::car::CentreOfGravityToGround / physics::car::WheelBase);
-			const auto axleLoadRear = physics::car::Mass * (physics::car::AxleLoadRatioRear * physics::Gravity + physics::car::WeightTransfer * m_localAccel.x * physics::car::CentreOfGravityToGround / physics::car::WheelBase);
+		const auto from = hitbox.bounds();
+		const auto to = moved.bounds();
 
-			const auto yawSpeedFront = physics::car::CentreOfGravityToFrontAxle * m_yawRate;
-			const auto yawSpeedRear = -physics::car::CentreOfGravityToRearAxle * m_yawRate;
+		auto impact = util::infinity<util::Fixed>();
 
-			const auto alphaFront = std::atan2(localVelocity.y + yawSpeedFront, std::abs(localVelocity.x)) - util::sign(localVelocity.x) * steer;
-			const auto alphaRear = std::atan2(localVelocity.y + yawSpeedRear, std::abs(localVelocity.x));
+		const util::BasicBounds<util::Fixed> swept { { std::min(from.m_min.x, to.m_min.x), std::min(from.m_min.y, to.m_min.y) }, { std::max(from.m_max.x, to.m_max.x), std::max(from.m_max.y, to.m_max.y) } };
+		static_cast<void>(anyFixed(swept, [this, &hitbox, displacement, &impact](u32 box) { impact = std::min(impact, hitbox.sweep(m_fixedHitboxes[box], displacement)); return false; }));
 
-			const auto tyreGripFront = physics::car::TyreGrip;
-			const auto tyreGripRear = physics::car::TyreGrip * (m_inputs[Handbrake] ? physics::car::LockGrip : 1.0);
+		return impact;
+	}
 
-			const auto frictionForceFront = std::clamp(-physics::car::CornerStiffnessFront * alphaFront, -tyreGripFront, tyreGripFront) * axleLoadFront;
-			const auto frictionForceRear = std::clamp(-physics::car::CornerStiffnessRear * alphaRear, -tyreGripRear, tyreGripRear) * axleLoadRear;
+	std::optional<util::BasicContact<util::Fixed>> Track::contact(const util::FixedOrientedBoundingBox &hitbox) const
+	{
+		std::optional<util::BasicContact<util::Fixed>> deepest;
 
-			const auto brakeForce = std::min((m_inputs[Brake] ? physics::car::BrakeForce : 0.0) + (m_inputs[Handbrake] ? physics::car::HandbrakeForce : 0.0), physics::car::BrakeForce);
-			const auto throttle = (m_inputs[Accelerate] ? physics::car::EngineForce : 0.0) + (m_inputs[Reverse] ? physics::car::EngineReverseForce : 0.0);
+		static_cast<void>(anyFixed(hitbox.bounds(), [this, &hitbox, &deepest](u32 box)
+		{
+			const auto contact = hitbox.contact(m_fixedHitboxes[box]);
+			if(contact && (!deepest || contact->m_depth > deepest->m_depth)) deepest = contact;
+			return false;
+		}));
 
-			const auto tractionForceX = throttle - brakeForce * util::sign(localVelocity.x);
-			const auto tractionForceY = 0.0;
+		return deepest;
+	}
 
-			const auto dragForceX = -physics::car::RollResistance * localVelocity.x - physics::AirResistance * localVelocity.x * std::abs(localVelocity.x);
-			const auto dragForceY = -physics::car::RollResistance * localVelocity.y - physics::AirResistance * localVelocity.y * std::abs(localVelocity.y);
+	Car::Car(glm::dvec2 position)
+		: m_position(position),
+		  m_prevPosition(position)
+	{
+		m_hitbox.m_position = position;
+		m_hitbox.m_size = physics::CarConstants<Spec, f64>::Size;
+		m_hitbox.m_rotation = m_rotation;
+	}
 
-			const auto totalForceX = dragForceX + tractionForceX;
-			const auto totalForceY = dragForceY + tractionForceY * std::cos(steer) * frictionForceFront + frictionForceRear;
+	void Car::integrate(const World &world, f64 delta)
+	{
+		const auto controls = physics::carControls<Spec>(m_inputs[Accelerate], m_inputs[Reverse], m_inputs[Brake], m_inputs[Left], m_inputs[Right], m_inputs[Handbrake], m_motion.m_absoluteVelocity);
 
-			m_localAccel.x = totalForceX / physics::car::Mass;
-			m_localAccel.y = totalForceY / physics::car::Mass;
+		const auto s = std::sin(m_hitbox.m_rotation);
+		const auto c = std::cos(m_hitbox.m_rotation);
 
-			const glm::dvec2 accel { c * m_localAccel.x - s * m_localAccel.y, s * m_localAccel.x + c * m_localAccel.y };
+		const auto slip = physics::carSlip<Spec>(m_motion, s, c);
+		physics::carIntegrate<Spec>(m_motion, slip, physics::carSlipAngles(slip, controls), controls, s, c, std::cos(controls.m_steer), delta);
 
-			// delta = 1/64
-			m_velocity += accel * delta;
+		const auto start = m_stepStart = m_hitbox.m_position;
+		const auto displacement = m_motion.m_velocity * delta;
 
-			m_absoluteVelocity = glm::length(m_velocity);
+		m_hitbox.m_position += displacement;
+		m_hitbox.m_rotation += m_motion.m_yawRate * delta;
 
-			f64 angularTorque;
+		// at low tick rates a fast car can end a tick past a thin wall, maybe inside another wall behind it,
+		// so it stops at the first wall along the whole move before it's pushed out of anything
+		f64 impact = INFINITY;
 
-			if(m_absoluteVelocity < 0.5 && throttle == 0.0)
-			{
-				m_velocity = { 0.0, 0.0 };
-				m_absoluteVelocity = angularTorque = m_yawRate = 0.0;
-			}
-			else angularTorque = (frictionForceFront + tractionForceY) * physics::car::CentreOfGravityToFrontAxle - frictionForceRear * physics::car::CentreOfGravityToRearAxle;
+		if(physics::canTunnel(m_hitbox.m_size, displacement))
+		{
+			auto from = m_hitbox;
+			from.m_position = start;
 
-			const auto angularAccel = angularTorque / physics::car::Inertia;
+			impact = firstImpact(world, from, displacement);
+			if(impact <= 1.0) m_hitbox.m_position = start + displacement * impact;
+		}
 
-			m_yawRate += angularAccel * delta;
+		auto contact = deepestContact(world);
 
-			m_hitbox.m_position += m_velocity * delta;
-			m_hitbox.m_rotation += m_yawRate * delta;
+		// just touching can round to just apart
+		if(impact <= 1.0 && !contact) physics::carBounceBack(m_motion);
 
-			//
+		pushOutOfWalls(world, contact);
+	}
 
-			// if it collides, reverse the direction and slow the car down a bit by BounceFactor amount
-			if(colliding(world))
-			{
-				m_velocity *= physics::BounceFactor; // velocity
-				m_yawRate *= physics::BounceFactor; // rotation speed
+	void Car::pushOutOfWalls(const World &world, std::optional<Contact> contact)
+	{
+		for(u32 i = 0; contact && i < physics::MaxContactIterations; ++i, contact = deepestContact(world))
+		{
+			physics::carBounce(m_motion, m_hitbox.m_position, contact->m_contact);
+		}
+	}
 
-				m_hitbox.m_position += m_velocity * delta;
-			}
+	util::Bounds Car::sweptBounds() const
+	{
+		// the box at the start of the step is the same box moved back, so its bounds are too
+		const auto bounds = m_hitbox.bounds();
+		const auto displacement = m_hitbox.m_position - m_stepStart;
 
-			// sets the car to the new position after it collides
-			m_rotation = m_hitbox.m_rotation;
-			m_position = m_hitbox.m_position;
+		return { glm::min(bounds.m_min, bounds.m_min - displacement), glm::max(bounds.m_max, bounds.m_max - displacement) };
+	}
 
-			const auto inStartLine = intersects(s_data->m_startingLineHitbox);
+	void Car::checkStartLine(const World &world)
+	{
+		const auto inStartLine = intersects(world.startingLine());
+		const auto moved = m_hitbox.m_position - m_stepStart;
 
-			// if it has either left or entered the starting line then start or end the lap depending on whether we entered or left the starting line
-			if(inStartLine != m_inStartLine)
-			{
-				if(inStartLine) endLap();
-				else startLap();
-			}
+		m_lapTrigger = LapTrigger::None;
 
-			m_inStartLine = inStartLine;
+		// if it has either left or entered the starting line then start or end the lap depending on whether we entered or left the starting line
+		if(inStartLine != m_inStartLine) m_lapTrigger = inStartLine ? LapTrigger::Enter : LapTrigger::Leave;
+		// a fast car can go all the way through the starting line in one tick
+		else if(!inStartLine && physics::canTunnel(m_hitbox.m_size, moved))
+		{
+			auto from = m_hitbox;
+			from.m_position = m_stepStart;
+
+			if(from.sweep(world.startingLine(), moved) <= 1.0) m_lapTrigger = LapTrigger::PassThrough;
 		}
+
+		m_inStartLine = inStartLine;
+	}
+
+	void Car::applyLapTrigger(World &world)
+	{
+		if(m_lapTrigger == LapTrigger::None) return;
+
+		if(m_lapTrigger != LapTrigger::Leave) endLap(world);
+		if(m_lapTrigger != LapTrigger::Enter) startLap(world);
+	}
+
+	// sets the car to where it ended up after every step of the tick
+	void Car::finishTick()
+	{
+		m_prevPosition = m_position;
+		m_prevRotation = m_rotation;
+
+		m_position = m_hitbox.m_position;
+		m_rotation = m_hitbox.m_rotation;
 	}
 
 	// return true if the car collides with the inputted hitbox
@@ -377,97 +364,113 @@ namespace game
 		return hitbox.intersects(m_hitbox);
 	}
 
-	// return true if the car collides with anything
-	bool Car::colliding(const World &world)
+	f64 Car::timeOfImpact(const util::OrientedBoundingBox &hitbox, glm::dvec2 displacement) const
 	{
-		return std::any_of(std::cbegin(world.entities()), std::cend(world.entities()),
-					 [this](const std::shared_ptr<Entity> &entity) { return entity.get() != this && entity->intersects(m_hitbox); });
+		return hitbox.sweep(m_hitbox, displacement);
 	}
 
-	void Car::startLap()
+	std::optional<Contact> Car::contact(const util::OrientedBoundingBox &hitbox) const
 	{
-		m_lapStartTime = glfwGetTime();
+		const auto contact = hitbox.contact(m_hitbox);
+		if(!contact) return std::nullopt;
+
+		return Contact { *contact, this };
 	}
 
-	void Car::endLap()
+	// goes through every static entity, there are only a few so they have no broadphase
+	std::optional<Contact> Car::deepestContact(const World &world) const
 	{
-		f64 lapTime = m_laps++ == 0 ? -1.0 : glfwGetTime() - m_lapStartTime;
-		m_lastLapTime = lapTime;
-		s_data->finishLap(*this, lapTime);
+		std::optional<Contact> deepest;
+
+		const auto keepDeepest = [&deepest](const std::optional<Contact> &contact)
+		{
+			if(contact && (!deepest || contact->m_contact.m_depth > deepest->m_contact.m_depth)) deepest = contact;
+		};
+
+		// the plain intersects test is batched and much cheaper, and most ticks touch nothing
+		for(const auto &entity : world.staticEntities())
+		{
+			if(entity->intersects(m_hitbox)) keepDeepest(entity->contact(m_hitbox));
+		}
+
+		return deepest;
 	}
 
-	PlayerCar::PlayerCar()
-		: m_accelerateKey(input::key(config::KeyAccelerate)),
-		  m_reverseKey(input::key(config::KeyReverse)),
-		  m_brakeKey(input::key(config::KeyBrake)),
-		  m_leftKey(input::key(config::KeySteerLeft)),
-		  m_rightKey(input::key(config::KeySteerRight)),
-		  m_handbrakeKey(input::key(config::KeyHandbrake))
+	f64 Car::firstImpact(const World &world, const util::OrientedBoundingBox &from, glm::dvec2 displacement) const
 	{
-		m_prevPosition = m_position = m_hitbox.m_position = m_sprite.m_position = PlayerStartPos;
-		m_sprite.m_textureOverride = &s_data->m_playerCarTexture; //gives the sprite the car texture
+		f64 impact = INFINITY;
+
+		for(const auto &entity : world.staticEntities())
+		{
+			impact = std::min(impact, entity->timeOfImpact(from, displacement));
+		}
+
+		return impact;
+	}
+
+	// returns the car's pose interpolated between the old and new position depending on how far through the tick it is
+	CarPose Car::pose(f64 partialTick) const
+	{
+		return { util::lerp(m_prevPosition, m_position, partialTick), util::lerp(m_prevRotation, m_rotation, partialTick) };
 	}
 
-	void PlayerCar::updateInputs(u64 tick)
+	CarSnapshot Car::snapshot() const
 	{
-		m_inputs[Accelerate] = m_accelerateKey.down();
-		m_inputs[Reverse] = m_reverseKey.down();
-		m_inputs[Brake] = m_brakeKey.down();
-		m_inputs[Left] = m_leftKey.down();
-		m_inputs[Right] = m_rightKey.down();
-		m_inputs[Handbrake] = m_handbrakeKey.down();
+		return { this, m_prevPosition, m_position, m_prevRotation, m_rotation, m_laps, m_lastLapTime };
 	}
 
-	void PlayerCar::render(Renderer &renderer, f64 partialTick)
+	CarPose CarSnapshot::pose(f64 partialTick) const
 	{
-		std::unique_lock lock(m_updateLock);
+		return { util::lerp(m_prevPosition, m_position, partialTick), util::lerp(m_prevRotation, m_rotation, partialTick) };
+	}
+
+	u8 Car::inputBits() const
+	{
+		u8 bits = 0;
 
-		if(m_lastLapTime > 0.0)
+		for(size_t i = 0; i < m_inputs.size(); ++i)
 		{
-			std::stringstream str;
-			str << "Racing game - last lap time: " << m_lastLapTime << " seconds";
-			m_lastLapTime = -1.0;
-			renderer.window().title(str.str());
+			if(m_inputs[i]) bits |= 1 << i;
 		}
 
-		renderer.drawQuad(m_sprite);
-
-		if constexpr(DrawHitboxes) drawHitbox(renderer, m_hitbox);
+		return bits;
 	}
 
-	// returns the position of the car and that's used to keep the car in the centre of the screen
-	// interpolates between the old position and new position of the car depending on how far through the tick it is
-	glm::dvec2 PlayerCar::updateFramePosition(f64 partialTick)
+	u32 Car::laps() const
 	{
-		std::unique_lock lock(m_updateLock);
-
-		m_sprite.m_rotation = util::lerp(m_prevRotation, m_rotation, partialTick);
-		return m_sprite.m_position = util::lerp(m_prevPosition, m_position, partialTick);
+		return m_laps;
 	}
 
-	void PlayerCar::winRace()
+	f64 Car::lastLapTime() const
 	{
-		std::cout << "You won the race! Your time: " << m_lastLapTime << " seconds" << std::endl;
+		return m_lastLapTime;
 	}
 
-	void PlayerCar::loseRace()
+	void Car::startLap(const World &world)
 	{
-		std::cout << "You lost the race! Your time: " << m_lastLapTime << " seconds" << std::endl;
+		m_lapStartTime = world.time();
 	}
 
-	NpcCar::NpcCar(u32 index)
-		: m_index(index)
+	void Car::endLap(World &world)
 	{
-		m_prevPosition = m_position = m_hitbox.m_position = m_sprite.m_position = NpcStartPos[index];
-		m_sprite.m_textureOverride = &s_data->m_npcCarTexture;
+		f64 lapTime = m_laps++ == 0 ? -1.0 : world.time() - m_lapStartTime;
+		m_lastLapTime = lapTime;
+		world.finishLap(*this, lapTime);
 	}
 
+	NpcCar::NpcCar(u32 index)
+		: Car(NpcStartPos[index]),
+		  m_index(index) {}
+
 	// updates the inputs based on if it is on the right tick or not
+	// every action since the last call is applied, so ticks can be skipped when running at a lower tick rate
 	void NpcCar::updateInputs(u64 tick)
 	{
+		const auto lastTick = std::exchange(m_lastTick, tick);
+
 		for(const auto &action : NpcInputs)
 		{
-			if(std::get<0>(action) + 1 == tick)
+			if(std::get<0>(action) + 1 > lastTick && std::get<0>(action) + 1 <= tick)
 			{
 				//std::cout << "tick " << (tick + 1) << ": input " << std::get<1>(action) << (std::get<2>(action) ? " on (" : " off (") << InputNames[std::get<1>(action)] << ')' << std::endl;
 				m_inputs[std::get<1>(action)] = std::get<2>(action);
@@ -475,49 +478,291 @@ namespace game
 		}
 	}
 
-	void NpcCar::render(Renderer &renderer, f64 partialTick)
-	{
-		std::unique_lock lock(m_updateLock);
-
-		m_sprite.m_position = util::lerp(m_prevPosition, m_position, partialTick);
-		m_sprite.m_rotation = util::lerp(m_prevRotation, m_rotation, partialTick);
+	World::World(u32 racers, u32 threads, u32 substeps)
+		: m_workers(threads),
+		  m_substeps(std::max(substeps, 1U)),
+		  m_startingLineHitbox({ -27.75, 15.35 / 3.0 }, 0.0, { 6.0, 3.0 }),
+		  m_racers(racers) {}
 
-		renderer.drawQuad(m_sprite);
+	World::~World() = default;
 
-		if constexpr(DrawHitboxes) drawHitbox(renderer, m_hitbox);
+	void World::moveCar(const Car &car)
+	{
+		m_carBroadphase.update(car.m_proxy, car.m_hitbox.bounds());
 	}
 
 	void World::tick(f64 delta, u64 tick)
 	{
 		std::shared_lock lock(m_entityLock);
 
-		for(auto &entity : m_entities)
+		for(auto &entity : m_staticEntities)
 		{
 			entity->tick(*this, delta, tick);
 		}
+
+		const auto cars = static_cast<u32>(m_cars.size());
+
+		// the inputs hold for the whole tick, more steps only make the physics more accurate
+		m_workers.forEach(cars, ParallelCars, [this, tick](u32 i) { m_cars[i]->updateInputs(tick); });
+
+		const auto start = m_time;
+
+		for(u32 step = 1; step <= m_substeps; ++step)
+		{
+			this->step(delta / m_substeps);
+
+			// the last step ends exactly where the tick does however delta divides
+			m_time = step == m_substeps ? start + delta : start + delta * step / m_substeps;
+		}
+
+		m_workers.forEach(cars, ParallelCars, [this](u32 i) { m_cars[i]->finishTick(); });
+
+		publishSnapshot();
+
+		if(m_recorder) m_recorder->record();
 	}
 
-	void World::render(Renderer &renderer, f64 partialTick)
+	void World::publishSnapshot()
 	{
-		std::shared_lock lock(m_entityLock);
+		auto &snapshot = m_snapshots.back();
+
+		snapshot.m_time = m_time;
+		snapshot.m_staticEntities.assign(std::cbegin(m_staticEntities), std::cend(m_staticEntities));
+		snapshot.m_cars.resize(m_cars.size());
+
+		m_workers.forEach(static_cast<u32>(m_cars.size()), ParallelCars, [this, &snapshot](u32 i) { snapshot.m_cars[i] = m_cars[i]->snapshot(); });
+
+		m_snapshots.publish();
+	}
+
+	void World::step(f64 delta)
+	{
+		const auto cars = static_cast<u32>(m_cars.size());
+
+		// a car only writes itself and only reads what isn't a car until the broadphase is updated
+		m_workers.forEach(cars, ParallelCars, [this, delta](u32 i) { m_cars[i]->integrate(*this, delta); });
+
+		// the broadphase is one sorted list, cars move in it one at a time,
+		// each is listed with the whole of its move so cars that went right through each other are still paired up
+		for(auto *car : m_cars)
+		{
+			m_carBroadphase.update(car->m_proxy, car->sweptBounds());
+		}
+
+		solveCarContacts();
 
-		for(auto &entity : m_entities)
+		// being pushed by another car can push a car into a wall
+		m_workers.forEach(cars, ParallelCars, [this](u32 i)
 		{
-			entity->render(renderer, partialTick);
+			if(auto *car = m_cars[i]; car->m_pushedByCar) car->pushOutOfWalls(*this, car->deepestContact(*this));
+		});
+
+		for(auto *car : m_cars)
+		{
+			if(std::exchange(car->m_pushedByCar, false)) moveCar(*car);
+		}
+
+		m_workers.forEach(cars, ParallelCars, [this](u32 i) { m_cars[i]->checkStartLine(*this); });
+
+		// finishing a lap changes who is winning, so laps are finished in car order
+		for(auto *car : m_cars)
+		{
+			car->applyLapTrigger(*this);
+		}
+	}
+
+	void World::solveCarContacts()
+	{
+		using car = physics::CarConstants<Car::Spec, f64>;
+
+		// find every overlapping pair first, each car lists the ones after it in proxy order so the result is the same every run
+		m_carNeighbours.resize(m_cars.size());
+
+		m_workers.forEach(static_cast<u32>(m_cars.size()), ParallelCars, [this](u32 i)
+		{
+			const auto *car = m_cars[i];
+			auto &neighbours = m_carNeighbours[i];
+
+			neighbours.clear();
+
+			m_carBroadphase.forEach(car->sweptBounds(), [this, car, &neighbours](u32 proxy)
+			{
+				if(proxy > car->m_proxy) neighbours.push_back(m_proxyCars[proxy]);
+			});
+		});
+
+		// each push moves cars that later pairs test, so they are resolved one at a time
+		for(size_t i = 0; i < m_cars.size(); ++i)
+		{
+			auto *a = m_cars[i];
+
+			for(auto *b : m_carNeighbours[i])
+			{
+				auto contact = a->m_hitbox.contact(b->m_hitbox);
+				if(!contact) contact = sweepCars(*a, *b);
+				if(!contact) continue;
+
+				const auto normal = contact->m_normal; // from b towards a
+
+				// the corners of each box furthest into the other, the contact is taken to be halfway between them
+				const auto deepest = [](const util::OrientedBoundingBox &box, glm::dvec2 direction)
+				{
+					const auto &vertices = box.geometry().m_vertices;
+					return *std::max_element(std::cbegin(vertices), std::cend(vertices), [direction](glm::dvec2 v0, glm::dvec2 v1) { return glm::dot(v0, direction) < glm::dot(v1, direction); });
+				};
+
+				const auto point = (deepest(a->m_hitbox, -normal) + deepest(b->m_hitbox, normal)) / 2.0;
+
+				const auto ra = point - a->m_hitbox.m_position;
+				const auto rb = point - b->m_hitbox.m_position;
+
+				const auto cross = [](glm::dvec2 v0, glm::dvec2 v1) { return v0.x * v1.y - v0.y * v1.x; };
+				const auto spin = [](f64 yawRate, glm::dvec2 r) { return glm::dvec2 { -yawRate * r.y, yawRate * r.x }; };
+
+				const auto relativeVelocity = a->m_motion.m_velocity + spin(a->m_motion.m_yawRate, ra) - b->m_motion.m_velocity - spin(b->m_motion.m_yawRate, rb);
+				const auto closing = glm::dot(relativeVelocity, normal);
+
+				// only push them apart if they are moving together, they might already be separating
+				if(closing < 0.0)
+				{
+					const auto raN = cross(ra, normal);
+					const auto rbN = cross(rb, normal);
+
+					const auto inverseMass = 2.0 / car::Mass + (raN * raN + rbN * rbN) / car::Inertia;
+					const auto impulse = (physics::BounceFactor<f64> - 1.0) * closing / inverseMass;
+
+					a->m_motion.m_velocity += normal * (impulse / car::Mass);
+					b->m_motion.m_velocity -= normal * (impulse / car::Mass);
+					a->m_motion.m_yawRate += raN * impulse / car::Inertia;
+					b->m_motion.m_yawRate -= rbN * impulse / car::Inertia;
+
+					a->m_motion.m_absoluteVelocity = glm::length(a->m_motion.m_velocity);
+					b->m_motion.m_absoluteVelocity = glm::length(b->m_motion.m_velocity);
+				}
+
+				// same mass, so each moves half of the way out
+				const auto push = normal * ((contact->m_depth + physics::ContactSlop<f64>) / 2.0);
+
+				a->m_hitbox.m_position += push;
+				b->m_hitbox.m_position -= push;
+
+				a->m_pushedByCar = b->m_pushedByCar = true;
+
+				moveCar(*a);
+				moveCar(*b);
+			}
 		}
+	}
 
-		if(DrawHitboxes) s_data->drawStartLineHitbox(renderer);
+	std::optional<util::Contact> World::sweepCars(Car &a, Car &b)
+	{
+		const auto displacementA = a.m_hitbox.m_position - a.m_stepStart;
+		const auto displacementB = b.m_hitbox.m_position - b.m_stepStart;
+		const auto relative = displacementA - displacementB;
+
+		if(!physics::canTunnel(a.m_hitbox.m_size, relative)) return std::nullopt;
+
+		// a where it started, seen from b where it is now
+		auto from = a.m_hitbox;
+		from.m_position = a.m_stepStart + displacementB;
+
+		// already touching at the start means they are moving apart, not through each other
+		const auto impact = b.timeOfImpact(from, relative);
+		if(!(impact > 0.0 && impact <= 1.0)) return std::nullopt;
+
+		// back both up to where they first touched
+		a.m_hitbox.m_position = a.m_stepStart + displacementA * impact;
+		b.m_hitbox.m_position = b.m_stepStart + displacementB * impact;
+
+		if(auto contact = a.m_hitbox.contact(b.m_hitbox)) return contact;
+
+		// just touching can round to just apart, push them apart along the way they were closing
+		return util::Contact { -relative / glm::length(relative), 0.0 };
 	}
 
 	void World::addEntity(std::shared_ptr<Entity> entity)
 	{
 		std::unique_lock lock(m_entityLock);
+
+		if(auto *car = dynamic_cast<Car *>(entity.get()))
+		{
+			car->m_proxy = m_carBroadphase.insert(car->m_hitbox.bounds());
+
+			if(car->m_proxy >= m_proxyCars.size()) m_proxyCars.resize(car->m_proxy + 1, nullptr);
+			m_proxyCars[car->m_proxy] = car;
+
+			updateCars();
+		}
+		else m_staticEntities.push_back(entity);
+
 		m_entities.push_back(std::move(entity));
 	}
 
 	void World::removeEntity(const std::shared_ptr<Entity> &entity)
 	{
 		std::unique_lock lock(m_entityLock);
+
+		if(auto *car = dynamic_cast<Car *>(entity.get()); car && car->m_proxy != util::SweepAndPrune::NoProxy)
+		{
+			m_carBroadphase.remove(car->m_proxy);
+			m_proxyCars[car->m_proxy] = nullptr;
+			car->m_proxy = util::SweepAndPrune::NoProxy;
+
+			updateCars();
+		}
+		else m_staticEntities.erase(std::remove(std::begin(m_staticEntities), std::end(m_staticEntities), entity), std::end(m_staticEntities));
+
 		m_entities.erase(std::remove_if(std::begin(m_entities), std::end(m_entities), [&entity](const std::shared_ptr<Entity> &elem) { return entity.get() == elem.get(); }), std::end(m_entities));
 	}
+
+	void World::updateCars()
+	{
+		m_cars.clear();
+		std::copy_if(std::cbegin(m_proxyCars), std::cend(m_proxyCars), std::back_inserter(m_cars), [](const Car *car) { return car != nullptr; });
+	}
+
+	bool World::startRecording(const std::string &path, f64 tickRate)
+	{
+		std::unique_lock lock(m_entityLock);
+
+		auto recorder = std::make_unique<InputRecorder>(path, *this, tickRate);
+		if(!*recorder) return false;
+
+		m_recorder = std::move(recorder);
+		return true;
+	}
+
+	void World::stopRecording()
+	{
+		std::unique_lock lock(m_entityLock);
+		m_recorder.reset();
+	}
+
+	void World::finishLap(Car &car, f64 time)
+	{
+		// this is called with -1 as the time the first time cars pass the start line
+		if(time < 0.0) return;
+
+		std::cout << "car finished with time " << time << " seconds" << std::endl;
+
+		if(time < m_fastestTime)
+		{
+			if(m_fastestCar) m_slowerCars.push_back(m_fastestCar);
+
+			m_fastestCar = &car;
+			m_fastestTime = time;
+
+			std::cout << "^ fastest time" << std::endl;
+		}
+
+		if(++m_finishedCars == m_racers)
+		{
+			m_fastestCar->winRace();
+
+			for(auto *slowCar : m_slowerCars)
+			{
+				slowCar->loseRace();
+			}
+		}
+	}
 }
@@ -2,19 +2,36 @@
 
 #include "types.h"
 #include "util.h"
-#include "render.h"
-#include "input.h"
+#include "grid.h"
+#include "field.h"
+#include "broadphase.h"
+#include "bvh.h"
+#include "physics.h"
+#include "fixed.h"
+#include "workers.h"
+#include "triplebuffer.h"
 #include <vector>
 #include <shared_mutex>
+#include <mutex>
 #include <memory>
 #include <array>
+#include <string>
+#include <optional>
+#include <utility>
 
 namespace game
 {
-	void loadGameData();
-	void destroyGameData();
-
 	class World;
+	class InputRecorder;
+	class Car;
+	class Entity;
+
+	// where a hitbox touches an entity and which entity it is, m_contact's normal points away from m_collider
+	struct Contact
+	{
+		util::Contact m_contact;
+		const Entity *m_collider;
+	};
 
 	class Entity
 	{
@@ -22,32 +39,106 @@ namespace game
 		Entity() = default;
 		virtual ~Entity() = default;
 
-		virtual void tick(World &world, f64 delta, u64 tick) = 0;
-		virtual void render(Renderer &renderer, f64 partialTick) = 0;
+		// only called on static entities, World::tick moves cars itself in phases over every car at once
+		virtual void tick([[maybe_unused]] World &world, [[maybe_unused]] f64 delta, [[maybe_unused]] u64 tick) {}
 
 		[[nodiscard]] virtual bool intersects(const util::OrientedBoundingBox &hitbox) const = 0;
+
+		// the fraction of displacement hitbox can move before it first touches this, infinity if it never does
+		// by default this checks intersects() at steps small enough that the box can't jump over anything
+		[[nodiscard]] virtual f64 timeOfImpact(const util::OrientedBoundingBox &hitbox, glm::dvec2 displacement) const;
+
+		// the deepest point hitbox overlaps this, nothing if it doesn't intersect
+		[[nodiscard]] virtual std::optional<Contact> contact(const util::OrientedBoundingBox &hitbox) const = 0;
+	};
+
+	// how the track tests hitboxes against collide.png
+	enum class TrackCollision
+	{
+		Hitboxes, // rectangles merged from the mask in a uniform grid, exact
+		Bvh, // the same rectangles in a bounding volume hierarchy, better when colliders are rotated or very different sizes
+		DistanceField // a signed distance field of the mask, a bounded number of lookups per test but approximate, races differ from the exact modes, added colliders are still exact
 	};
 
 	class Track : public Entity
 	{
 	public:
-		Track();
+		explicit Track(TrackCollision collision = TrackCollision::Hitboxes);
 		~Track() override = default;
 
 		void tick(World &world, f64 delta, u64 tick) override;
-		void render(Renderer &renderer, f64 partialTick) override;
 
 		[[nodiscard]] bool intersects(const util::OrientedBoundingBox &hitbox) const override;
+		[[nodiscard]] f64 timeOfImpact(const util::OrientedBoundingBox &hitbox, glm::dvec2 displacement) const override;
+		[[nodiscard]] std::optional<Contact> contact(const util::OrientedBoundingBox &hitbox) const override;
+
+		// adds rotated barriers or other extra colliders to the track, they are tested like the track's own hitboxes
+		// the world shouldn't be ticking while this rebuilds the collision structures
+		void addColliders(const std::vector<util::OrientedBoundingBox> &colliders);
+
+		// the same tests in fixed point for cars that have to come out the same on every machine, the grid or bvh only
+		// picks which hitboxes to test so the answers don't depend on f64, a distance field has no fixed point version
+		// so with TrackCollision::DistanceField only added colliders are tested
+		[[nodiscard]] bool intersects(const util::FixedOrientedBoundingBox &hitbox) const;
+		[[nodiscard]] util::Fixed timeOfImpact(const util::FixedOrientedBoundingBox &hitbox, glm::vec<2, util::Fixed> displacement) const;
+		[[nodiscard]] std::optional<util::BasicContact<util::Fixed>> contact(const util::FixedOrientedBoundingBox &hitbox) const;
+
+		// distance to the nearest wall and the direction away from it, only with TrackCollision::DistanceField
+		[[nodiscard]] inline auto wallDistance(glm::dvec2 point) const { return m_field.sample(point); }
+
+		[[nodiscard]] inline auto &hitboxes() const { return m_hitboxes; }
+		[[nodiscard]] inline auto collision() const { return m_collision; }
 
 	private:
-		RenderableQuad m_sprite {};
+		TrackCollision m_collision;
+
 		std::vector<util::OrientedBoundingBox> m_hitboxes;
+		std::vector<util::FixedOrientedBoundingBox> m_fixedHitboxes; // m_hitboxes converted to fixed point
+		util::HitboxGrid m_grid; // only with TrackCollision::Hitboxes
+		util::HitboxBvh m_bvh; // with every other TrackCollision, only holds added colliders with DistanceField
+
+		util::DistanceField m_field;
+
+		void buildColliders();
+
+		// calls test with every hitbox that might touch a fixed point box with these bounds, stops as soon as test returns true
+		template <typename Test>
+		bool anyFixed(const util::BasicBounds<util::Fixed> &bounds, Test &&test) const;
+	};
+
+	// position and rotation of a car, interpolated between the last two ticks
+	struct CarPose
+	{
+		glm::dvec2 m_position;
+		f64 m_rotation;
+	};
+
+	// what is drawn of a car, copied out at the end of every tick
+	struct CarSnapshot
+	{
+		const Car *m_car; // only for telling cars apart, the car might be gone by the time the snapshot is read
+
+		glm::dvec2 m_prevPosition, m_position;
+		f64 m_prevRotation, m_rotation;
+
+		u32 m_laps;
+		f64 m_lastLapTime;
+
+		[[nodiscard]] CarPose pose(f64 partialTick) const;
+	};
+
+	// everything the renderer needs from the world after a tick, so it never has to lock the world or a car
+	struct WorldSnapshot
+	{
+		f64 m_time = 0.0; // World::time() after the tick
+		std::vector<std::shared_ptr<const Entity>> m_staticEntities; // these don't change while the world ticks
+		std::vector<CarSnapshot> m_cars; // in the order the world ticks them
 	};
 
 	class Car : public Entity
 	{
 	public:
-		Car();
+		explicit Car(glm::dvec2 position);
 		~Car() override = default;
 
 		static constexpr size_t Accelerate = 0;
@@ -57,14 +148,28 @@ namespace game
 		static constexpr size_t Right = 4;
 		static constexpr size_t Handbrake = 5;
 
-		virtual void updateInputs(u64 tick) = 0;
+		// every car in a world drives the same, CarBatch is for other specs
+		static constexpr const physics::CarSpec &Spec = physics::cars::Standard;
 
-		void tick(World &world, f64 delta, u64 tick) final;
+		virtual void updateInputs(u64 tick) = 0;
 
 		virtual void winRace() {}
 		virtual void loseRace() {}
 
 		[[nodiscard]] bool intersects(const util::OrientedBoundingBox &hitbox) const override;
+		[[nodiscard]] f64 timeOfImpact(const util::OrientedBoundingBox &hitbox, glm::dvec2 displacement) const override;
+		[[nodiscard]] std::optional<Contact> contact(const util::OrientedBoundingBox &hitbox) const override;
+
+		// these are for the thread ticking the world, other threads read World::snapshot()
+		[[nodiscard]] CarPose pose(f64 partialTick) const;
+		[[nodiscard]] CarSnapshot snapshot() const;
+
+		// the inputs used in the last tick, one bit per input
+		[[nodiscard]] u8 inputBits() const;
+
+		[[nodiscard]] inline auto &hitbox() const { return m_hitbox; }
+		[[nodiscard]] u32 laps() const;
+		[[nodiscard]] f64 lastLapTime() const;
 
 	protected:
 		std::array<bool, 6> m_inputs { false, false, false, false, false, false };
@@ -72,51 +177,66 @@ namespace game
 		bool m_inStartLine = false;
 		f64 m_lastLapTime = -1.0;
 
-		RenderableQuad m_sprite {};
-		std::mutex m_updateLock {};
-
 		glm::dvec2 m_position { 0.0 };
 		f64 m_rotation = util::toRad(90.0);
 
 		glm::dvec2 m_prevPosition { m_position };
 		f64 m_prevRotation { m_rotation };
 
-		glm::dvec2 m_velocity { 0.0 };
-
-		glm::dvec2 m_localAccel { 0.0 };
-		f64 m_absoluteVelocity = 0.0;
-
-		f64 m_yawRate = 0.0;
+		physics::CarMotion<f64> m_motion {};
 
 		util::OrientedBoundingBox m_hitbox {};
 
 		u32 m_laps = 0;
-		f64 m_lapStartTime;
+		f64 m_lapStartTime = 0.0;
 
-		void startLap();
-		void endLap();
+		u32 m_proxy = util::SweepAndPrune::NoProxy; // set by the world the car is in
 
-		[[nodiscard]] bool colliding(const World &world);
-	};
+		// what crossing the starting line did this tick, found in parallel and then applied to the world in car order
+		enum class LapTrigger : u8
+		{
+			None,
+			Enter, // ends a lap
+			Leave, // starts one
+			PassThrough // both, a fast car can go all the way through in one tick
+		};
 
-	class PlayerCar : public Car
-	{
-	public:
-		PlayerCar();
-		~PlayerCar() override = default;
+		LapTrigger m_lapTrigger = LapTrigger::None;
 
-		void updateInputs(u64 tick) override;
-		void render(Renderer &renderer, f64 partialTick) override;
+		glm::dvec2 m_stepStart { m_position }; // where m_hitbox was before the last integrate
 
-		[[nodiscard]] glm::dvec2 updateFramePosition(f64 partialTick);
+		bool m_pushedByCar = false; // set by the world's solver so the car is checked against walls again
 
-		void winRace() override;
-		void loseRace() override;
+		// moves m_hitbox a step and pushes it out of everything that isn't a car, only reads the world
+		void integrate(const World &world, f64 delta);
 
-	private:
-		const input::Key &m_accelerateKey, &m_reverseKey, &m_brakeKey, &m_leftKey, &m_rightKey, &m_handbrakeKey;
+		// starting from contact, only reads the world
+		void pushOutOfWalls(const World &world, std::optional<Contact> contact);
+
+		// covers m_hitbox all the way from m_stepStart
+		[[nodiscard]] util::Bounds sweptBounds() const;
+
+		// only reads the world, the car has to have been through the world's solver first
+		void checkStartLine(const World &world);
+		void applyLapTrigger(World &world);
+
+		// after the last step, moves the pose pose() interpolates from to where m_hitbox ended up
+		void finishTick();
+
+		void startLap(const World &world);
+		void endLap(World &world);
+
+		// the deepest contact with the track or anything else that isn't a car, other cars are left to World's solver
+		[[nodiscard]] std::optional<Contact> deepestContact(const World &world) const;
+
+		[[nodiscard]] f64 firstImpact(const World &world, const util::OrientedBoundingBox &from, glm::dvec2 displacement) const;
+
+		friend class World;
 	};
 
+	// how many npc cars have a starting position on the grid
+	constexpr u32 NpcCarCount = 3;
+
 	class NpcCar : public Car
 	{
 	public:
@@ -126,26 +246,55 @@ namespace game
 		[[nodiscard]] inline auto index() const { return m_index; }
 
 		void updateInputs(u64 tick) override;
-		void render(Renderer &renderer, f64 partialTick) override;
 
 	private:
 		u32 m_index;
+		u64 m_lastTick = 0;
 	};
 
+	// ticks in phases: inputs, then for each physics step integrate, broadphase, car against car contacts and lap triggers,
+	// each car only writes itself in the parallel phases and anything shared is done in proxy order,
+	// so the result is the same whichever car goes first and however many threads there are
 	class World
 	{
 	public:
-		World() = default;
-		~World() = default;
+		// the car phases are split between threads threads, 0 for every hardware thread,
+		// each tick is simulated in substeps equal steps with the inputs of the tick, 1 is what the game uses
+		explicit World(u32 racers = 4, u32 threads = 1, u32 substeps = 1);
+		~World();
 
 		void tick(f64 delta, u64 tick);
-		void render(Renderer &renderer, f64 partialTick);
 
 		void addEntity(std::shared_ptr<Entity> entity);
 		void removeEntity(const std::shared_ptr<Entity> &entity);
 
+		// this is called when a car finishes a lap
+		void finishLap(Car &car, f64 time);
+
+		// records the inputs of every car currently in the world after each tick,
+		// cars shouldn't be added or removed until the recording is stopped
+		// tickRate is how many ticks a second the world is ticked at, which is saved so the replay can run at it too
+		bool startRecording(const std::string &path, f64 tickRate);
+		void stopRecording();
+
 		[[nodiscard]] inline auto &entities() const { return m_entities; }
 
+		// everything that isn't a car, cars are only tested against each other by World's own solver
+		[[nodiscard]] inline auto &staticEntities() const { return m_staticEntities; }
+
+		// the world as of the newest tick, published without locking so the thread drawing it never holds up ticking,
+		// only one thread may read snapshots and what this returns stays the same until it calls this again
+		[[nodiscard]] inline auto &snapshot() const { return m_snapshots.front(); }
+
+		// simulated time in seconds, advanced by every tick
+		[[nodiscard]] inline auto time() const { return m_time; }
+
+		[[nodiscard]] inline auto substeps() const { return m_substeps; }
+
+		[[nodiscard]] inline auto &startingLine() const { return m_startingLineHitbox; }
+		[[nodiscard]] inline auto racers() const { return m_racers; }
+		[[nodiscard]] inline auto finished() const { return m_finishedCars >= m_racers; }
+
 		World(const World &) = delete;
 		World(World &&) = delete;
 
@@ -153,7 +302,50 @@ namespace game
 		World &operator=(World &&) = delete;
 
 	private:
-		std::shared_mutex m_entityLock;
+		mutable std::shared_mutex m_entityLock;
 		std::vector<std::shared_ptr<Entity>> m_entities;
+
+		std::vector<std::shared_ptr<Entity>> m_staticEntities;
+		util::SweepAndPrune m_carBroadphase;
+		std::vector<Car *> m_proxyCars; // indexed by the car's proxy in m_carBroadphase
+		std::vector<Car *> m_cars; // m_proxyCars without the gaps, the order every phase goes through cars in
+		std::vector<std::vector<Car *>> m_carNeighbours; // the cars after each of m_cars that it might touch, reused by solveCarContacts
+
+		static constexpr u32 ParallelCars = 64; // fewer cars than this per thread aren't worth handing out
+		util::WorkerPool m_workers;
+
+		f64 m_time = 0.0;
+		u32 m_substeps;
+
+		std::unique_ptr<InputRecorder> m_recorder;
+
+		util::OrientedBoundingBox m_startingLineHitbox;
+
+		u32 m_racers;
+		u32 m_finishedCars = 0;
+
+		// one physics step of every car, from integrating to the lap triggers
+		void step(f64 delta);
+
+		// after every car has moved, pushes overlapping cars apart and exchanges momentum between them
+		void solveCarContacts();
+
+		// where two cars that went right through each other in this step first touched, after moving them back there,
+		// nothing if they didn't
+		[[nodiscard]] static std::optional<util::Contact> sweepCars(Car &a, Car &b);
+
+		// has to be called after a car moves so the others can find it
+		void moveCar(const Car &car);
+
+		// rebuilds m_cars after a car is added or removed
+		void updateCars();
+
+		mutable util::TripleBuffer<WorldSnapshot> m_snapshots; // written by tick, read by snapshot()
+
+		void publishSnapshot();
+
+		Car *m_fastestCar = nullptr;
+		std::vector<Car *> m_slowerCars;
+		f64 m_fastestTime = INFINITY;
 	};
 }
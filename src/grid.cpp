@@ -0,0 +1,88 @@
+#include "grid.h"
+#include <cmath>
+#include <algorithm>
+
+namespace game::util
+{
+	HitboxGrid::HitboxGrid(const std::vector<OrientedBoundingBox> &boxes, f64 cellSize)
+		: m_cellSize(cellSize)
+	{
+		if(boxes.empty()) return;
+
+		std::vector<Bounds> bounds;
+		bounds.reserve(boxes.size());
+
+		Bounds total { glm::dvec2 { INFINITY }, glm::dvec2 { -INFINITY } };
+
+		for(const auto &box : boxes)
+		{
+			const auto &boxBounds = bounds.emplace_back(box.bounds());
+			total.m_min = glm::min(total.m_min, boxBounds.m_min);
+			total.m_max = glm::max(total.m_max, boxBounds.m_max);
+		}
+
+		m_origin = total.m_min;
+		m_cells = glm::ivec2 { glm::floor((total.m_max - total.m_min) / cellSize) } + 1;
+
+		// counting sort the boxes into their cells
+		m_cellStarts.assign(static_cast<size_t>(m_cells.x * m_cells.y) + 1, 0);
+		m_firstCells.reserve(boxes.size());
+
+		for(const auto &boxBounds : bounds)
+		{
+			const auto min = cellOf(boxBounds.m_min);
+			const auto max = cellOf(boxBounds.m_max);
+
+			m_firstCells.push_back(min);
+
+			for(i32 y = min.y; y <= max.y; ++y)
+			{
+				for(i32 x = min.x; x <= max.x; ++x) ++m_cellStarts[x + y * m_cells.x + 1];
+			}
+		}
+
+		for(size_t i = 1; i < m_cellStarts.size(); ++i) m_cellStarts[i] += m_cellStarts[i - 1];
+
+		m_boxes.resize(m_cellStarts.back());
+
+		auto next = m_cellStarts;
+
+		for(u32 box = 0; box < bounds.size(); ++box)
+		{
+			const auto min = m_firstCells[box];
+			const auto max = cellOf(bounds[box].m_max);
+
+			for(i32 y = min.y; y <= max.y; ++y)
+			{
+				for(i32 x = min.x; x <= max.x; ++x) m_boxes[next[x + y * m_cells.x]++] = box;
+			}
+		}
+
+		m_cellHitboxes.reserve(m_boxes.size());
+		for(const auto box : m_boxes) m_cellHitboxes.add(boxes[box]);
+	}
+
+	bool HitboxGrid::intersects(const OrientedBoundingBox &box) const
+	{
+		if(m_cells.x == 0 || m_cells.y == 0) return false;
+
+		const auto bounds = box.bounds();
+		const auto min = cellOf(bounds.m_min - QueryPadding);
+		const auto max = cellOf(bounds.m_max + QueryPadding);
+
+		// a box in several cells of a row gets tested more than once, which doesn't change the answer
+		for(i32 y = min.y; y <= max.y; ++y)
+		{
+			const auto row = y * m_cells.x;
+			if(m_cellHitboxes.anyIntersects(box, m_cellStarts[row + min.x], m_cellStarts[row + max.x + 1])) return true;
+		}
+
+		return false;
+	}
+
+	glm::ivec2 HitboxGrid::cellOf(glm::dvec2 point) const
+	{
+		const glm::ivec2 cell { glm::floor((point - m_origin) / m_cellSize) };
+		return glm::clamp(cell, glm::ivec2 { 0 }, m_cells - 1);
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "types.h"
+#include "util.h"
+#include "hitboxes.h"
+#include <vector>
+#include <algorithm>
+#include <glm/common.hpp>
+
+namespace game::util
+{
+	// uniform grid over static hitboxes, each box is listed in every cell its bounds touch
+	// so a query only looks at the boxes near it
+	class HitboxGrid
+	{
+	public:
+		HitboxGrid() = default;
+		HitboxGrid(const std::vector<OrientedBoundingBox> &boxes, f64 cellSize);
+		~HitboxGrid() = default;
+
+		// calls visit with the index of every box whose cells overlap bounds, each box once
+		template <typename Visit>
+		void forEach(const Bounds &bounds, Visit &&visit) const
+		{
+			static_cast<void>(any(bounds, [&visit](u32 box) { visit(box); return false; }));
+		}
+
+		// calls test with the index of every box whose cells overlap bounds, each box at most once,
+		// stops and returns true as soon as test does
+		template <typename Test>
+		bool any(const Bounds &bounds, Test &&test) const
+		{
+			if(m_cells.x == 0 || m_cells.y == 0) return false;
+
+			const auto min = cellOf(bounds.m_min - QueryPadding);
+			const auto max = cellOf(bounds.m_max + QueryPadding);
+
+			for(i32 y = min.y; y <= max.y; ++y)
+			{
+				for(i32 x = min.x; x <= max.x; ++x)
+				{
+					const auto cell = static_cast<u32>(x + y * m_cells.x);
+
+					for(u32 i = m_cellStarts[cell]; i < m_cellStarts[cell + 1]; ++i)
+					{
+						const auto box = m_boxes[i];
+						const auto &boxMin = m_firstCells[box];
+
+						// a box spanning several cells is only tested in the first cell it shares with the query
+						if(x == std::max(boxMin.x, min.x) && y == std::max(boxMin.y, min.y) && test(box)) return true;
+					}
+				}
+			}
+
+			return false;
+		}
+
+		// true if box intersects any of the boxes, tests each row of cells as one batch
+		[[nodiscard]] bool intersects(const OrientedBoundingBox &box) const;
+
+		[[nodiscard]] inline auto cells() const { return m_cells; }
+
+	private:
+		glm::dvec2 m_origin { 0.0 };
+		f64 m_cellSize = 1.0;
+		glm::ivec2 m_cells { 0, 0 };
+
+		std::vector<u32> m_cellStarts; // where each cell's boxes start in m_boxes, one extra at the end
+		std::vector<u32> m_boxes;
+		std::vector<glm::ivec2> m_firstCells; // the lowest cell each box is in
+		HitboxStore m_cellHitboxes; // a copy of the box for every entry in m_boxes, so each row of cells is contiguous
+
+		[[nodiscard]] glm::ivec2 cellOf(glm::dvec2 point) const;
+	};
+}
@@ -0,0 +1,95 @@
+#include "histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace game::util
+{
+	namespace
+	{
+		[[nodiscard]] u32 log2Floor(u64 v)
+		{
+			u32 log = 0;
+			while(v >>= 1) ++log;
+			return log;
+		}
+	}
+
+	void Histogram::record(f64 seconds)
+	{
+		const auto ns = static_cast<u64>(std::max(0.0, seconds * 1e9));
+
+		m_buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+		m_count.fetch_add(1, std::memory_order_relaxed);
+		m_sum.fetch_add(ns, std::memory_order_relaxed);
+
+		auto max = m_max.load(std::memory_order_relaxed);
+		while(ns > max && !m_max.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {}
+	}
+
+	u64 Histogram::count() const
+	{
+		return m_count.load(std::memory_order_relaxed);
+	}
+
+	f64 Histogram::mean() const
+	{
+		const auto count = this->count();
+		return count == 0 ? 0.0 : static_cast<f64>(m_sum.load(std::memory_order_relaxed)) / static_cast<f64>(count) * 1e-9;
+	}
+
+	f64 Histogram::max() const
+	{
+		return static_cast<f64>(m_max.load(std::memory_order_relaxed)) * 1e-9;
+	}
+
+	f64 Histogram::percentile(f64 p) const
+	{
+		// the buckets are read one at a time, so this is only approximate while something is recording
+		u64 total = 0;
+		for(const auto &bucket : m_buckets) total += bucket.load(std::memory_order_relaxed);
+
+		if(total == 0) return 0.0;
+
+		const auto target = std::max(u64 { 1 }, static_cast<u64>(std::ceil(std::clamp(p, 0.0, 1.0) * static_cast<f64>(total))));
+
+		u64 seen = 0;
+
+		for(u32 i = 0; i < BucketCount; ++i)
+		{
+			if((seen += m_buckets[i].load(std::memory_order_relaxed)) >= target)
+			{
+				return static_cast<f64>(std::min(bucketUpperBound(i), m_max.load(std::memory_order_relaxed))) * 1e-9;
+			}
+		}
+
+		return max();
+	}
+
+	void Histogram::print(std::ostream &out, const std::string &name) const
+	{
+		out << name << ": " << count() << " samples, mean " << mean() * 1000.0 << " ms, p50 " << percentile(0.5) * 1000.0
+			<< " ms, p99 " << percentile(0.99) * 1000.0 << " ms, p99.9 " << percentile(0.999) * 1000.0
+			<< " ms, max " << max() * 1000.0 << " ms" << std::endl;
+	}
+
+	// values below SubBuckets get a bucket each, above that every power of two is split into SubBuckets linear buckets
+	u32 Histogram::bucketOf(u64 ns)
+	{
+		if(ns < SubBuckets) return static_cast<u32>(ns);
+
+		const auto exponent = log2Floor(ns);
+		const auto sub = static_cast<u32>(ns >> (exponent - SubBucketBits)) & (SubBuckets - 1);
+
+		return (exponent - SubBucketBits + 1) * SubBuckets + sub;
+	}
+
+	u64 Histogram::bucketUpperBound(u32 bucket)
+	{
+		if(bucket < SubBuckets) return bucket;
+
+		const auto exponent = bucket / SubBuckets + SubBucketBits - 1;
+		const auto sub = u64 { bucket % SubBuckets };
+
+		return ((SubBuckets + sub + 1) << (exponent - SubBucketBits)) - 1;
+	}
+}
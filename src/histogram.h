@@ -0,0 +1,48 @@
+#pragma once
+
+#include "types.h"
+#include <array>
+#include <atomic>
+#include <ostream>
+#include <string>
+
+namespace game::util
+{
+	// lock-free histogram of durations, safe to record into from one thread while others read it
+	// buckets are log-linear (16 per power of two nanoseconds), so percentiles are within about 6%
+	class Histogram
+	{
+	public:
+		Histogram() = default;
+		~Histogram() = default;
+
+		void record(f64 seconds);
+
+		[[nodiscard]] u64 count() const;
+		[[nodiscard]] f64 mean() const;
+		[[nodiscard]] f64 max() const;
+		[[nodiscard]] f64 percentile(f64 p) const; //p is between 0 and 1, returns seconds
+
+		// prints count, mean, p50, p99, p99.9 and max in milliseconds on one line
+		void print(std::ostream &out, const std::string &name) const;
+
+		Histogram(const Histogram &) = delete;
+		Histogram(Histogram &&) = delete;
+
+		Histogram &operator=(const Histogram &) = delete;
+		Histogram &operator=(Histogram &&) = delete;
+
+	private:
+		static constexpr u32 SubBucketBits = 4;
+		static constexpr u32 SubBuckets = 1 << SubBucketBits;
+		static constexpr u32 BucketCount = (64 - SubBucketBits + 1) * SubBuckets;
+
+		std::array<std::atomic<u64>, BucketCount> m_buckets {};
+		std::atomic<u64> m_count { 0 };
+		std::atomic<u64> m_sum { 0 }; //nanoseconds
+		std::atomic<u64> m_max { 0 }; //nanoseconds
+
+		[[nodiscard]] static u32 bucketOf(u64 ns);
+		[[nodiscard]] static u64 bucketUpperBound(u32 bucket);
+	};
+}
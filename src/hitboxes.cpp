@@ -0,0 +1,166 @@
+#include "hitboxes.h"
+#include <glm/geometric.hpp>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GAME_HITBOXES_SIMD 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GAME_HITBOXES_SIMD 1
+#else
+#define GAME_HITBOXES_SIMD 0
+#endif
+
+namespace game::util
+{
+	namespace
+	{
+#if defined(__AVX2__)
+		struct Lanes
+		{
+			using Vec = __m256d;
+			static constexpr u32 Width = 4;
+
+			static inline Vec load(const f64 *p) { return _mm256_loadu_pd(p); }
+			static inline Vec set(f64 v) { return _mm256_set1_pd(v); }
+			static inline Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+			static inline Vec sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+			static inline Vec mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+			static inline Vec abs(Vec a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+			static inline Vec greater(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+			static inline Vec lessEqual(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+			static inline Vec notEqual(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ); }
+			static inline Vec either(Vec a, Vec b) { return _mm256_or_pd(a, b); }
+			static inline Vec both(Vec a, Vec b) { return _mm256_and_pd(a, b); }
+			static inline u32 mask(Vec a) { return static_cast<u32>(_mm256_movemask_pd(a)); }
+		};
+#elif GAME_HITBOXES_SIMD
+		struct Lanes
+		{
+			using Vec = __m128d;
+			static constexpr u32 Width = 2;
+
+			static inline Vec load(const f64 *p) { return _mm_loadu_pd(p); }
+			static inline Vec set(f64 v) { return _mm_set1_pd(v); }
+			static inline Vec add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+			static inline Vec sub(Vec a, Vec b) { return _mm_sub_pd(a, b); }
+			static inline Vec mul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+			static inline Vec abs(Vec a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+			static inline Vec greater(Vec a, Vec b) { return _mm_cmpgt_pd(a, b); }
+			static inline Vec lessEqual(Vec a, Vec b) { return _mm_cmple_pd(a, b); }
+			static inline Vec notEqual(Vec a, Vec b) { return _mm_cmpneq_pd(a, b); }
+			static inline Vec either(Vec a, Vec b) { return _mm_or_pd(a, b); }
+			static inline Vec both(Vec a, Vec b) { return _mm_and_pd(a, b); }
+			static inline u32 mask(Vec a) { return static_cast<u32>(_mm_movemask_pd(a)); }
+		};
+#endif
+	}
+
+	void HitboxStore::add(const OrientedBoundingBox &box)
+	{
+		m_x.push_back(box.m_position.x);
+		m_y.push_back(box.m_position.y);
+		m_sizeX.push_back(box.m_size.x);
+		m_sizeY.push_back(box.m_size.y);
+		m_halfX.push_back(box.m_size.x / 2.0);
+		m_halfY.push_back(box.m_size.y / 2.0);
+		m_radius.push_back(glm::length(box.m_size) / 2.0);
+		m_rotation.push_back(box.m_rotation);
+	}
+
+	void HitboxStore::reserve(size_t count)
+	{
+		for(auto *array : { &m_x, &m_y, &m_sizeX, &m_sizeY, &m_halfX, &m_halfY, &m_radius, &m_rotation }) array->reserve(count);
+	}
+
+	OrientedBoundingBox HitboxStore::operator[](u32 index) const
+	{
+		return { { m_x[index], m_y[index] }, m_rotation[index], { m_sizeX[index], m_sizeY[index] } };
+	}
+
+	bool HitboxStore::anyIntersectsScalar(const OrientedBoundingBox &box, u32 begin, u32 end) const
+	{
+		for(u32 i = begin; i < end; ++i)
+		{
+			if(box.intersects((*this)[i])) return true;
+		}
+
+		return false;
+	}
+
+	// the lanes do the same sums in the same order as OrientedBoundingBox::intersects, so the results match exactly
+	// stored boxes with a rotation are rare and are left to the scalar test
+	bool HitboxStore::anyIntersects(const OrientedBoundingBox &box, u32 begin, u32 end) const
+	{
+#if GAME_HITBOXES_SIMD
+		using L = Lanes;
+
+		const auto qx = L::set(box.m_position.x);
+		const auto qy = L::set(box.m_position.y);
+		const auto zero = L::set(0.0);
+
+		u32 i = begin;
+
+		if(box.m_rotation == 0.0)
+		{
+			const auto qSizeX = L::set(box.m_size.x);
+			const auto qSizeY = L::set(box.m_size.y);
+			const auto half = L::set(0.5);
+
+			for(; i + L::Width <= end; i += L::Width)
+			{
+				const auto rotated = L::notEqual(L::load(&m_rotation[i]), zero);
+
+				const auto extentX = L::mul(L::add(qSizeX, L::load(&m_sizeX[i])), half);
+				const auto extentY = L::mul(L::add(qSizeY, L::load(&m_sizeY[i])), half);
+
+				const auto hit = L::both(L::lessEqual(L::abs(L::sub(L::load(&m_x[i]), qx)), extentX),
+										 L::lessEqual(L::abs(L::sub(L::load(&m_y[i]), qy)), extentY));
+
+				if(L::mask(hit) & ~L::mask(rotated)) return true;
+				if(L::mask(rotated) && anyIntersectsScalar(box, i, i + L::Width)) return true;
+			}
+		}
+		else
+		{
+			const auto &geometry = box.geometry();
+
+			const auto vs = L::set(geometry.m_sin), vc = L::set(geometry.m_cos);
+			const auto as = L::set(std::abs(geometry.m_sin)), ac = L::set(std::abs(geometry.m_cos));
+			const auto qHalfX = L::set(geometry.m_halfsize.x);
+			const auto qHalfY = L::set(geometry.m_halfsize.y);
+			const auto qRadius = L::set(geometry.m_radius);
+
+			for(; i + L::Width <= end; i += L::Width)
+			{
+				const auto rotated = L::notEqual(L::load(&m_rotation[i]), zero);
+
+				const auto dx = L::sub(L::load(&m_x[i]), qx);
+				const auto dy = L::sub(L::load(&m_y[i]), qy);
+				const auto halfX = L::load(&m_halfX[i]);
+				const auto halfY = L::load(&m_halfY[i]);
+
+				// bounding circles
+				const auto radii = L::add(qRadius, L::load(&m_radius[i]));
+				auto miss = L::greater(L::add(L::mul(dx, dx), L::mul(dy, dy)), L::mul(radii, radii));
+
+				// the stored box's axes
+				miss = L::either(miss, L::greater(L::abs(dx), L::add(L::add(halfX, L::mul(ac, qHalfX)), L::mul(as, qHalfY))));
+				miss = L::either(miss, L::greater(L::abs(dy), L::add(L::add(halfY, L::mul(as, qHalfX)), L::mul(ac, qHalfY))));
+
+				// the query box's axes
+				miss = L::either(miss, L::greater(L::abs(L::add(L::mul(vc, dx), L::mul(vs, dy))), L::add(L::add(qHalfX, L::mul(ac, halfX)), L::mul(as, halfY))));
+				miss = L::either(miss, L::greater(L::abs(L::sub(L::mul(vc, dy), L::mul(vs, dx))), L::add(L::add(qHalfY, L::mul(as, halfX)), L::mul(ac, halfY))));
+
+				if(~L::mask(miss) & ~L::mask(rotated) & ((1U << L::Width) - 1)) return true;
+				if(L::mask(rotated) && anyIntersectsScalar(box, i, i + L::Width)) return true;
+			}
+		}
+
+		return anyIntersectsScalar(box, i, end);
+#else
+		return anyIntersectsScalar(box, begin, end);
+#endif
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "types.h"
+#include "util.h"
+#include <vector>
+
+namespace game::util
+{
+	// static hitboxes stored as separate arrays of each field so many can be tested against one box at once
+	// uses AVX2 (4 boxes per instruction) when built with it, otherwise SSE2 (2 boxes) on x86 or plain code elsewhere
+	class HitboxStore
+	{
+	public:
+		HitboxStore() = default;
+		~HitboxStore() = default;
+
+		void add(const OrientedBoundingBox &box);
+		void reserve(size_t count);
+
+		[[nodiscard]] inline auto size() const { return static_cast<u32>(m_x.size()); }
+		[[nodiscard]] OrientedBoundingBox operator[](u32 index) const;
+
+		// same result as box.intersects() on each of the boxes from begin to end, true if any of them hit
+		[[nodiscard]] bool anyIntersects(const OrientedBoundingBox &box, u32 begin, u32 end) const;
+		[[nodiscard]] inline bool anyIntersects(const OrientedBoundingBox &box) const { return anyIntersects(box, 0, size()); }
+
+		// the same test without SIMD, used for the last few boxes and for checking the SIMD kernel
+		[[nodiscard]] bool anyIntersectsScalar(const OrientedBoundingBox &box, u32 begin, u32 end) const;
+
+	private:
+		std::vector<f64> m_x, m_y;
+		std::vector<f64> m_sizeX, m_sizeY;
+		std::vector<f64> m_halfX, m_halfY;
+		std::vector<f64> m_radius; // half the diagonal
+		std::vector<f64> m_rotation;
+	};
+}
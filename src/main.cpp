@@ -1,6 +1,8 @@
 #include "engine.h"
+#include <string>
 
-int main()
+// racing_game [--record <file>]
+int main(int argc, char **argv)
 {
-	return game::start();
+	return game::start(argc > 2 && std::string(argv[1]) == "--record" ? argv[2] : "");
 }
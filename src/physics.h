@@ -0,0 +1,255 @@
+#pragma once
+
+#include "types.h"
+#include "util.h"
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <string_view>
+#include <glm/vec2.hpp>
+
+// Marco Monster's car physics model, with reversing
+// split around its trig so CarBatch can run everything else over many cars in vectorised loops,
+// Car and CarBatch go through the same functions so they give exactly the same results,
+// everything is templated on the scalar type so a batch can run in f32 or util::Fixed as well,
+// maths functions are called unqualified so the ones for util::Fixed are found by argument dependent lookup
+namespace game::physics
+{
+	template <typename T> constexpr T Gravity = T(9.80665);
+	template <typename T> constexpr T AirResistance = T(2.5);
+	template <typename T> constexpr T BounceFactor = T(-0.6); // the part of the speed into a wall that is kept, reversed
+	template <typename T> constexpr T ContactSlop = T(1e-6); // how far past touching cars are pushed out of walls so the next tick starts clear
+	constexpr u32 MaxContactIterations = 4; // a car in a corner touches more than one wall
+
+	// what makes one class of car drive differently from another, used as a template parameter so every class gets
+	// its own model with the numbers folded in, CarSpecs lists them for picking one at runtime
+	struct CarSpec
+	{
+		const char *m_name;
+		f64 m_mass;
+		f64 m_inertiaScale;
+		f64 m_centreOfGravityToFrontAxle;
+		f64 m_centreOfGravityToRearAxle;
+		f64 m_centreOfGravityToGround;
+		f64 m_tyreGrip;
+		f64 m_lockGrip;
+		f64 m_engineForce;
+		f64 m_engineReverseScale;
+		f64 m_brakeForce;
+		f64 m_handbrakeForce;
+		f64 m_weightTransfer;
+		f64 m_cornerStiffnessFront;
+		f64 m_cornerStiffnessRear;
+		f64 m_rollResistance;
+		glm::dvec2 m_size;
+	};
+
+	namespace cars
+	{
+		// the car everyone drives in the game
+		inline constexpr CarSpec Standard { "standard", 1200.0, 1.0, 1.25, 1.25, 0.55, 2.0, 0.7, 8000.0, 0.6, 12000.0, 4800.0, 0.2, 5.0, 5.2, 8.0, { 2.1, 1.3 } };
+		inline constexpr CarSpec Sports { "sports", 1000.0, 1.0, 1.15, 1.3, 0.45, 2.4, 0.75, 11000.0, 0.5, 14000.0, 5000.0, 0.15, 5.5, 5.8, 7.0, { 2.0, 1.25 } };
+		inline constexpr CarSpec Van { "van", 1900.0, 1.2, 1.5, 1.5, 0.8, 1.7, 0.65, 9000.0, 0.6, 13000.0, 5000.0, 0.25, 4.5, 4.8, 10.0, { 2.6, 1.5 } };
+	}
+
+	// a spec's index here is how it's picked at runtime, see CarBatch
+	inline constexpr std::array<const CarSpec *, 3> CarSpecs { &cars::Standard, &cars::Sports, &cars::Van };
+
+	// the index in CarSpecs of the spec called name
+	[[nodiscard]] inline std::optional<u32> findCarSpec(std::string_view name)
+	{
+		for(u32 i = 0; i < CarSpecs.size(); ++i)
+		{
+			if(CarSpecs[i]->m_name == name) return i;
+		}
+
+		return std::nullopt;
+	}
+
+	// a spec's numbers in the scalar the model runs in, along with what's worked out from them
+	template <const CarSpec &Spec, typename T>
+	struct CarConstants
+	{
+		static constexpr T Mass = T(Spec.m_mass);
+		static constexpr T InertiaScale = T(Spec.m_inertiaScale);
+		static constexpr T CentreOfGravityToFrontAxle = T(Spec.m_centreOfGravityToFrontAxle);
+		static constexpr T CentreOfGravityToRearAxle = T(Spec.m_centreOfGravityToRearAxle);
+		static constexpr T CentreOfGravityToGround = T(Spec.m_centreOfGravityToGround);
+		static constexpr T TyreGrip = T(Spec.m_tyreGrip);
+		static constexpr T LockGrip = T(Spec.m_lockGrip);
+		static constexpr T EngineForce = T(Spec.m_engineForce);
+		static constexpr T EngineReverseScale = T(Spec.m_engineReverseScale);
+		static constexpr T BrakeForce = T(Spec.m_brakeForce);
+		static constexpr T HandbrakeForce = T(Spec.m_handbrakeForce);
+		static constexpr T WeightTransfer = T(Spec.m_weightTransfer);
+		static constexpr T CornerStiffnessFront = T(Spec.m_cornerStiffnessFront);
+		static constexpr T CornerStiffnessRear = T(Spec.m_cornerStiffnessRear);
+		static constexpr T RollResistance = T(Spec.m_rollResistance);
+
+		static constexpr T Inertia = Mass * InertiaScale;
+		static constexpr T WheelBase = CentreOfGravityToFrontAxle + CentreOfGravityToRearAxle;
+		static constexpr T AxleLoadRatioFront = CentreOfGravityToRearAxle / WheelBase;
+		static constexpr T AxleLoadRatioRear = CentreOfGravityToFrontAxle / WheelBase;
+		static constexpr T EngineReverseForce = -EngineForce * EngineReverseScale;
+
+		static constexpr glm::vec<2, T> Size { T(Spec.m_size.x), T(Spec.m_size.y) };
+	};
+
+	// what a car's physics carries over from one tick to the next, apart from where it is
+	template <typename T>
+	struct CarMotion
+	{
+		glm::vec<2, T> m_velocity { T(0) };
+		glm::vec<2, T> m_localAccel { T(0) };
+		T m_absoluteVelocity = T(0);
+		T m_yawRate = T(0);
+	};
+
+	// what the inputs ask of the car this tick
+	template <typename T>
+	struct CarControls
+	{
+		T m_steer;
+		T m_throttle;
+		T m_brakeForce;
+		T m_rearGrip;
+	};
+
+	// the velocity in the car's frame and what the slip angles need the arctangent of
+	template <typename T>
+	struct CarSlip
+	{
+		glm::vec<2, T> m_localVelocity;
+		T m_frontLateral, m_rearLateral;
+		T m_forward;
+	};
+
+	template <const CarSpec &Spec, typename T>
+	[[nodiscard]] inline CarControls<T> carControls(bool accelerate, bool reverse, bool brake, bool left, bool right, bool handbrake, T absoluteVelocity)
+	{
+		using car = CarConstants<Spec, T>;
+
+		const auto steerAmount = T(1) - std::min(absoluteVelocity, T(250)) / T(280);
+
+		auto steer = T(0);
+
+		if(left) steer += steerAmount;
+		if(right) steer -= steerAmount;
+
+		const auto brakeForce = std::min((brake ? car::BrakeForce : T(0)) + (handbrake ? car::HandbrakeForce : T(0)), car::BrakeForce);
+		const auto throttle = (accelerate ? car::EngineForce : T(0)) + (reverse ? car::EngineReverseForce : T(0));
+
+		return { steer, throttle, brakeForce, car::TyreGrip * (handbrake ? car::LockGrip : T(1)) };
+	}
+
+	// s and c are the sine and cosine of the car's rotation
+	template <const CarSpec &Spec, typename T>
+	[[nodiscard]] inline CarSlip<T> carSlip(const CarMotion<T> &motion, T s, T c)
+	{
+		using car = CarConstants<Spec, T>;
+		using std::abs;
+
+		const glm::vec<2, T> localVelocity { c * motion.m_velocity.x + s * motion.m_velocity.y, c * motion.m_velocity.y - s * motion.m_velocity.x };
+
+		const auto yawSpeedFront = car::CentreOfGravityToFrontAxle * motion.m_yawRate;
+		const auto yawSpeedRear = -car::CentreOfGravityToRearAxle * motion.m_yawRate;
+
+		return { localVelocity, localVelocity.y + yawSpeedFront, localVelocity.y + yawSpeedRear, abs(localVelocity.x) };
+	}
+
+	// the slip angles of the front and rear wheels, the only part of the model that needs a trig call per car
+	template <typename T>
+	[[nodiscard]] inline glm::vec<2, T> carSlipAngles(const CarSlip<T> &slip, const CarControls<T> &controls)
+	{
+		using std::atan2;
+
+		return { atan2(slip.m_frontLateral, slip.m_forward) - static_cast<T>(util::sign(slip.m_localVelocity.x)) * controls.m_steer, atan2(slip.m_rearLateral, slip.m_forward) };
+	}
+
+	// applies a tick of forces to motion, cosSteer is the cosine of controls.m_steer
+	template <const CarSpec &Spec, typename T>
+	inline void carIntegrate(CarMotion<T> &motion, const CarSlip<T> &slip, glm::vec<2, T> slipAngles, const CarControls<T> &controls, T s, T c, T cosSteer, T delta)
+	{
+		using car = CarConstants<Spec, T>;
+		using std::abs;
+
+		const auto &localVelocity = slip.m_localVelocity;
+
+		const auto axleLoadFront = car::Mass * (car::AxleLoadRatioFront * Gravity<T> - car::WeightTransfer * motion.m_localAccel.x * car::CentreOfGravityToGround / car::WheelBase);
+		const auto axleLoadRear = car::Mass * (car::AxleLoadRatioRear * Gravity<T> + car::WeightTransfer * motion.m_localAccel.x * car::CentreOfGravityToGround / car::WheelBase);
+
+		const auto frictionForceFront = std::clamp(-car::CornerStiffnessFront * slipAngles.x, -car::TyreGrip, car::TyreGrip) * axleLoadFront;
+		const auto frictionForceRear = std::clamp(-car::CornerStiffnessRear * slipAngles.y, -controls.m_rearGrip, controls.m_rearGrip) * axleLoadRear;
+
+		const auto tractionForceX = controls.m_throttle - controls.m_brakeForce * static_cast<T>(util::sign(localVelocity.x));
+		const auto tractionForceY = T(0);
+
+		const auto dragForceX = -car::RollResistance * localVelocity.x - AirResistance<T> * localVelocity.x * abs(localVelocity.x);
+		const auto dragForceY = -car::RollResistance * localVelocity.y - AirResistance<T> * localVelocity.y * abs(localVelocity.y);
+
+		const auto totalForceX = dragForceX + tractionForceX;
+		const auto totalForceY = dragForceY + tractionForceY * cosSteer * frictionForceFront + frictionForceRear;
+
+		motion.m_localAccel.x = totalForceX / car::Mass;
+		motion.m_localAccel.y = totalForceY / car::Mass;
+
+		const glm::vec<2, T> accel { c * motion.m_localAccel.x - s * motion.m_localAccel.y, s * motion.m_localAccel.x + c * motion.m_localAccel.y };
+
+		motion.m_velocity += accel * delta;
+
+		motion.m_absoluteVelocity = util::length(motion.m_velocity);
+
+		T angularTorque;
+
+		if(motion.m_absoluteVelocity < T(0.5) && controls.m_throttle == T(0))
+		{
+			motion.m_velocity = { T(0), T(0) };
+			motion.m_absoluteVelocity = angularTorque = motion.m_yawRate = T(0);
+		}
+		else angularTorque = (frictionForceFront + tractionForceY) * car::CentreOfGravityToFrontAxle - frictionForceRear * car::CentreOfGravityToRearAxle;
+
+		const auto angularAccel = angularTorque / car::Inertia;
+
+		motion.m_yawRate += angularAccel * delta;
+	}
+
+	// what hitting a wall does to a car's spin, it keeps turning the same way but slower
+	template <typename T>
+	inline void carBounceYaw(CarMotion<T> &motion)
+	{
+		motion.m_yawRate *= -BounceFactor<T>;
+	}
+
+	// pushes a car out of a wall and takes away most of the speed going into it,
+	// the speed along the wall is kept so cars slide along walls instead of sticking to them
+	template <typename T>
+	inline void carBounce(CarMotion<T> &motion, glm::vec<2, T> &position, const util::BasicContact<T> &contact)
+	{
+		position += contact.m_normal * (contact.m_depth + ContactSlop<T>);
+
+		if(const auto into = util::dot(motion.m_velocity, contact.m_normal); into < T(0))
+		{
+			motion.m_velocity -= (T(1) - BounceFactor<T>) * into * contact.m_normal;
+			carBounceYaw(motion);
+		}
+	}
+
+	// for a car that hit a wall but came out just touching it, so there's no normal to push it out along,
+	// sends it straight back the way it came
+	template <typename T>
+	inline void carBounceBack(CarMotion<T> &motion)
+	{
+		motion.m_velocity *= BounceFactor<T>;
+		carBounceYaw(motion);
+	}
+
+	// true if moving by displacement in one go could skip over a wall,
+	// the box covers at least its smallest side along any direction so moving less than that can't
+	template <typename T>
+	[[nodiscard]] inline bool canTunnel(glm::vec<2, T> size, glm::vec<2, T> displacement)
+	{
+		const auto smallest = std::min(size.x, size.y);
+		return util::dot(displacement, displacement) > smallest * smallest;
+	}
+}
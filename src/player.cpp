@@ -0,0 +1,40 @@
+#include "player.h"
+#include "config.h"
+#include <iostream>
+
+namespace game
+{
+	namespace
+	{
+		constexpr glm::dvec2 PlayerStartPos { -28.7, 2.0 };
+	}
+
+	PlayerCar::PlayerCar()
+		: Car(PlayerStartPos),
+		  m_accelerateKey(input::key(config::KeyAccelerate)),
+		  m_reverseKey(input::key(config::KeyReverse)),
+		  m_brakeKey(input::key(config::KeyBrake)),
+		  m_leftKey(input::key(config::KeySteerLeft)),
+		  m_rightKey(input::key(config::KeySteerRight)),
+		  m_handbrakeKey(input::key(config::KeyHandbrake)) {}
+
+	void PlayerCar::updateInputs([[maybe_unused]] u64 tick)
+	{
+		m_inputs[Accelerate] = m_accelerateKey.down();
+		m_inputs[Reverse] = m_reverseKey.down();
+		m_inputs[Brake] = m_brakeKey.down();
+		m_inputs[Left] = m_leftKey.down();
+		m_inputs[Right] = m_rightKey.down();
+		m_inputs[Handbrake] = m_handbrakeKey.down();
+	}
+
+	void PlayerCar::winRace()
+	{
+		std::cout << "You won the race! Your time: " << m_lastLapTime << " seconds" << std::endl;
+	}
+
+	void PlayerCar::loseRace()
+	{
+		std::cout << "You lost the race! Your time: " << m_lastLapTime << " seconds" << std::endl;
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "types.h"
+#include "game.h"
+#include "input.h"
+
+namespace game
+{
+	// the car driven with the keyboard, only available when there's a window to read input from
+	class PlayerCar : public Car
+	{
+	public:
+		PlayerCar();
+		~PlayerCar() override = default;
+
+		void updateInputs(u64 tick) override;
+
+		void winRace() override;
+		void loseRace() override;
+
+	private:
+		const input::Key &m_accelerateKey, &m_reverseKey, &m_brakeKey, &m_leftKey, &m_rightKey, &m_handbrakeKey;
+	};
+}
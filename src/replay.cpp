@@ -0,0 +1,138 @@
+#include "replay.h"
+#include <iostream>
+#include <array>
+
+namespace game
+{
+	namespace
+	{
+		constexpr std::array<char, 4> Magic { 'R', 'G', 'I', 'R' };
+		constexpr u32 Version = 2;
+
+		// the file is written in the machine's byte order, recordings are for replaying on the same kind of machine
+		template <typename T>
+		void write(std::ostream &out, const T &value)
+		{
+			out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+		}
+
+		template <typename T>
+		bool read(std::istream &in, T &value)
+		{
+			return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+		}
+	}
+
+	InputRecorder::InputRecorder(const std::string &path, const World &world, f64 tickRate)
+		: m_out(path, std::ios::out | std::ios::binary)
+	{
+		if(!m_out)
+		{
+			std::cerr << "Failed to open recording \"" << path << '\"' << std::endl;
+			return;
+		}
+
+		auto collision = TrackCollision::Hitboxes;
+
+		for(const auto &entity : world.entities())
+		{
+			if(const auto *car = dynamic_cast<const Car *>(entity.get())) m_cars.push_back(car);
+			else if(const auto *track = dynamic_cast<const Track *>(entity.get())) collision = track->collision();
+		}
+
+		m_tickInputs.resize(m_cars.size());
+
+		write(m_out, Magic);
+		write(m_out, Version);
+		write(m_out, world.racers());
+		write(m_out, tickRate);
+		write(m_out, world.substeps());
+		write(m_out, static_cast<u32>(collision));
+		write(m_out, static_cast<u32>(m_cars.size()));
+
+		for(const auto *car : m_cars)
+		{
+			const auto pose = car->pose(1.0);
+
+			write(m_out, pose.m_position.x);
+			write(m_out, pose.m_position.y);
+			write(m_out, pose.m_rotation);
+		}
+	}
+
+	void InputRecorder::record()
+	{
+		for(size_t i = 0; i < m_cars.size(); ++i)
+		{
+			m_tickInputs[i] = m_cars[i]->inputBits();
+		}
+
+		m_out.write(reinterpret_cast<const char *>(m_tickInputs.data()), static_cast<std::streamsize>(m_tickInputs.size()));
+	}
+
+	std::optional<InputRecording> loadRecording(const std::string &path)
+	{
+		std::ifstream in(path, std::ios::in | std::ios::binary);
+
+		if(!in)
+		{
+			std::cerr << "Failed to open recording \"" << path << '\"' << std::endl;
+			return {};
+		}
+
+		std::array<char, 4> magic {};
+		u32 version = 0, collision = 0, cars = 0;
+		InputRecording recording;
+
+		if(!read(in, magic) || magic != Magic || !read(in, version) || version != Version || !read(in, recording.m_racers) ||
+		   !read(in, recording.m_tickRate) || !read(in, recording.m_substeps) || !read(in, collision) || !read(in, cars))
+		{
+			std::cerr << '\"' << path << "\" is not a version " << Version << " recording" << std::endl;
+			return {};
+		}
+
+		if(!(recording.m_tickRate > 0.0) || recording.m_substeps == 0 || collision > static_cast<u32>(TrackCollision::DistanceField))
+		{
+			std::cerr << "Recording \"" << path << "\" has an invalid tick rate, substeps or collision" << std::endl;
+			return {};
+		}
+
+		recording.m_collision = static_cast<TrackCollision>(collision);
+
+		recording.m_cars.resize(cars);
+
+		for(auto &car : recording.m_cars)
+		{
+			if(!read(in, car.m_position.x) || !read(in, car.m_position.y) || !read(in, car.m_rotation))
+			{
+				std::cerr << "Recording \"" << path << "\" is truncated" << std::endl;
+				return {};
+			}
+		}
+
+		recording.m_inputs.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+		// drop a partly written last tick
+		recording.m_inputs.resize(recording.ticks() * cars);
+
+		return { std::move(recording) };
+	}
+
+	ReplayCar::ReplayCar(std::shared_ptr<const InputRecording> recording, u32 index)
+		: Car(recording->m_cars[index].m_position),
+		  m_recording(std::move(recording)),
+		  m_index(index)
+	{
+		m_prevRotation = m_rotation = m_hitbox.m_rotation = m_recording->m_cars[index].m_rotation;
+	}
+
+	void ReplayCar::updateInputs([[maybe_unused]] u64 tick)
+	{
+		const u8 bits = m_nextTick < m_recording->ticks() ? m_recording->inputs(m_nextTick++, m_index) : 0;
+
+		for(size_t i = 0; i < m_inputs.size(); ++i)
+		{
+			m_inputs[i] = (bits >> i) & 1;
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "types.h"
+#include "game.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <optional>
+#include <memory>
+
+namespace game
+{
+	// a race's per-tick car inputs, replaying them through World::tick gives the same race again with the same build,
+	// the world runs in f64 so another compiler, flags or libm can drift from it, only a FixedCarBatch is the same everywhere
+	// it only comes out the same with the tick rate, substeps and track collision it was recorded with
+	struct InputRecording
+	{
+		u32 m_racers = 0;
+		f64 m_tickRate = 0.0; // ticks per second
+		u32 m_substeps = 1;
+		TrackCollision m_collision = TrackCollision::Hitboxes;
+		std::vector<CarPose> m_cars; // where each car started
+		std::vector<u8> m_inputs; // Car::inputBits for every car, one tick after another
+
+		[[nodiscard]] inline u64 ticks() const { return m_cars.empty() ? 0 : m_inputs.size() / m_cars.size(); }
+		[[nodiscard]] inline u8 inputs(u64 tick, u32 car) const { return m_inputs[tick * m_cars.size() + car]; }
+	};
+
+	// writes the inputs of every car in a world to a file, World::startRecording makes one of these
+	class InputRecorder
+	{
+	public:
+		InputRecorder(const std::string &path, const World &world, f64 tickRate);
+		~InputRecorder() = default;
+
+		void record();
+
+		[[nodiscard]] inline explicit operator bool() const { return static_cast<bool>(m_out); }
+
+		InputRecorder(const InputRecorder &) = delete;
+		InputRecorder(InputRecorder &&) = delete;
+
+		InputRecorder &operator=(const InputRecorder &) = delete;
+		InputRecorder &operator=(InputRecorder &&) = delete;
+
+	private:
+		std::ofstream m_out;
+		std::vector<const Car *> m_cars;
+		std::vector<u8> m_tickInputs;
+	};
+
+	[[nodiscard]] std::optional<InputRecording> loadRecording(const std::string &path);
+
+	// drives with the inputs from a recording, one tick of them per tick
+	class ReplayCar : public Car
+	{
+	public:
+		ReplayCar(std::shared_ptr<const InputRecording> recording, u32 index);
+		~ReplayCar() override = default;
+
+		[[nodiscard]] inline auto index() const { return m_index; }
+
+		void updateInputs(u64 tick) override;
+
+	private:
+		std::shared_ptr<const InputRecording> m_recording;
+		u32 m_index;
+		u64 m_nextTick = 0;
+	};
+}
@@ -0,0 +1,96 @@
+#include "scene.h"
+#include <sstream>
+#include <algorithm>
+
+namespace game
+{
+	namespace
+	{
+		constexpr auto DrawHitboxes = false; //change to make the hitboxes appear
+
+		void drawHitbox(Renderer &renderer, const util::OrientedBoundingBox &hitbox, const glm::vec3 tint = { 0.0F, 1.0F, 0.0F })
+		{
+			RenderableQuad hitboxSprite {};
+
+			hitboxSprite.m_position = hitbox.m_position;
+			hitboxSprite.m_rotation = hitbox.m_rotation;
+			hitboxSprite.m_scale = hitbox.m_size;
+			hitboxSprite.m_tint = tint;
+
+			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+			renderer.drawQuad(hitboxSprite);
+			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		}
+	}
+
+	Scene::Scene(std::shared_ptr<PlayerCar> player)
+		: m_trackTexture("track"),
+		  m_playerCarTexture("car"),
+		  m_npcCarTexture("car2"),
+		  m_player(std::move(player)) {}
+
+	void Scene::render(const World &world, const WorldSnapshot &snapshot, Renderer &renderer, f64 partialTick)
+	{
+		const auto player = std::find_if(std::cbegin(snapshot.m_cars), std::cend(snapshot.m_cars), [this](const CarSnapshot &car) { return car.m_car == m_player.get(); });
+
+		if(player != std::cend(snapshot.m_cars) && player->m_laps != m_shownLaps)
+		{
+			m_shownLaps = player->m_laps;
+
+			if(player->m_lastLapTime > 0.0)
+			{
+				std::stringstream str;
+				str << "Racing game - last lap time: " << player->m_lastLapTime << " seconds";
+				renderer.window().title(str.str());
+			}
+		}
+
+		// the camera keeps the player's car in the centre of the screen
+		renderer.beginFrame(player != std::cend(snapshot.m_cars) ? player->pose(partialTick).m_position : glm::dvec2 { 0.0 });
+
+		for(const auto &entity : snapshot.m_staticEntities)
+		{
+			if(const auto *track = dynamic_cast<const Track *>(entity.get())) drawTrack(renderer, *track);
+		}
+
+		for(const auto &car : snapshot.m_cars)
+		{
+			drawCar(renderer, car, car.pose(partialTick));
+		}
+
+		if constexpr(DrawHitboxes) drawHitbox(renderer, world.startingLine(), { 1.0, 0.0, 1.0 });
+
+		renderer.endFrame();
+	}
+
+	//draws track hitboxes as well as track if it's enabled
+	void Scene::drawTrack(Renderer &renderer, const Track &track)
+	{
+		RenderableQuad sprite {};
+		sprite.m_scale = { 64.0, 36.0 };
+		sprite.m_textureOverride = &m_trackTexture;
+
+		renderer.drawQuad(sprite);
+
+		if constexpr(DrawHitboxes)
+		{
+			for(const auto &hitbox : track.hitboxes())
+			{
+				drawHitbox(renderer, hitbox);
+			}
+		}
+	}
+
+	void Scene::drawCar(Renderer &renderer, const CarSnapshot &car, const CarPose &pose)
+	{
+		RenderableQuad sprite {};
+		sprite.m_position = pose.m_position;
+		sprite.m_rotation = pose.m_rotation;
+		sprite.m_scale = { 3.0, 1.6 };
+		sprite.m_textureOverride = car.m_car == m_player.get() ? &m_playerCarTexture : &m_npcCarTexture;
+
+		renderer.drawQuad(sprite);
+
+		if constexpr(DrawHitboxes) drawHitbox(renderer, { pose.m_position, pose.m_rotation, physics::CarConstants<Car::Spec, f64>::Size });
+	}
+}
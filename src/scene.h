@@ -0,0 +1,36 @@
+#pragma once
+
+#include "types.h"
+#include "render.h"
+#include "game.h"
+#include "player.h"
+#include <memory>
+
+namespace game
+{
+	// draws a world, this is the only part of the game that needs the world to be rendered
+	class Scene
+	{
+	public:
+		explicit Scene(std::shared_ptr<PlayerCar> player);
+		~Scene() = default;
+
+		// draws a whole frame centred on the player's car, only the snapshot is read while the world ticks
+		void render(const World &world, const WorldSnapshot &snapshot, Renderer &renderer, f64 partialTick);
+
+		Scene(const Scene &) = delete;
+		Scene(Scene &&) = delete;
+
+		Scene &operator=(const Scene &) = delete;
+		Scene &operator=(Scene &&) = delete;
+
+	private:
+		gl::SingleTexture m_trackTexture, m_playerCarTexture, m_npcCarTexture;
+
+		std::shared_ptr<PlayerCar> m_player;
+		u32 m_shownLaps = 0;
+
+		void drawTrack(Renderer &renderer, const Track &track);
+		void drawCar(Renderer &renderer, const CarSnapshot &car, const CarPose &pose);
+	};
+}
@@ -0,0 +1,91 @@
+#include "tick.h"
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+namespace game
+{
+	TickThread::TickThread(World &world, std::shared_ptr<util::Clock> clock)
+		: m_world(world),
+		  m_clock(std::move(clock)),
+		  m_thread([this]() { run(); }) {}
+
+	TickThread::~TickThread()
+	{
+		if(m_thread.joinable()) stop();
+	}
+
+	void TickThread::startCountingTicks()
+	{
+		m_countTicks.store(true, std::memory_order_release);
+	}
+
+	void TickThread::stop()
+	{
+		m_stop.store(true, std::memory_order_release);
+		m_thread.join();
+
+		m_tickTimes.print(std::cout, "tick time");
+		m_oversleep.print(std::cout, "tick oversleep");
+		m_intervals.print(std::cout, "tick interval");
+
+		std::cout << "dropped " << (std::round(droppedTime() * 100000.0) / 100.0) << " ms of ticks catching up after stalls" << std::endl;
+	}
+
+	f64 TickThread::partialTick(f64 worldTime) const
+	{
+		return std::clamp((m_clock->now() - worldTime - m_timeOffset.load(std::memory_order_acquire)) * TicksPerSecond, 0.0, 1.0);
+	}
+
+	void TickThread::run()
+	{
+		auto tickedUntil = m_clock->now();
+		m_lastTick.store(tickedUntil, std::memory_order_release);
+		m_timeOffset.store(tickedUntil - m_world.time(), std::memory_order_release);
+
+		auto prevTickStart = tickedUntil;
+
+		u64 ticks = 0;
+		bool first = true;
+
+		while(!m_stop.load(std::memory_order_acquire))
+		{
+			const auto time = m_clock->now();
+
+			if(const auto behind = time - tickedUntil - MaxCatchUpTicks * TickLength; behind > 0.0)
+			{
+				tickedUntil += behind;
+				m_droppedTime.store(droppedTime() + behind, std::memory_order_release);
+				m_timeOffset.store(tickedUntil - m_world.time(), std::memory_order_release);
+			}
+
+			while(tickedUntil + TickLength <= time && !m_stop.load(std::memory_order_acquire))
+			{
+				const auto tickStart = m_clock->now();
+
+				if(!first) m_intervals.record(tickStart - prevTickStart);
+				first = false;
+				prevTickStart = tickStart;
+
+				const auto realStart = util::now();
+				m_world.tick(TickLength, ticks);
+				if(m_countTicks.load(std::memory_order_acquire)) ticks++;
+
+				const auto tickTime = util::now() - realStart;
+
+				m_tickTimes.record(tickTime);
+
+				if(tickTime > TickLength) std::cerr << "tick took " << (std::round(tickTime * 100000.0) / 100.0) << " ms, should take max " << (std::round(TickLength * 100000.0) / 100.0) << " ms" << std::endl;
+
+				tickedUntil += TickLength;
+				m_lastTick.store(tickedUntil, std::memory_order_release);
+			}
+
+			// the next tick is due once the clock passes the end of the time it simulates
+			if(const auto targetTime = tickedUntil + TickLength; m_clock->now() < targetTime)
+			{
+				if(const auto late = m_clock->sleepUntil(targetTime)) m_oversleep.record(*late);
+			}
+		}
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "types.h"
+#include "game.h"
+#include "histogram.h"
+#include "clock.h"
+#include <atomic>
+#include <thread>
+#include <memory>
+
+namespace game
+{
+	// changing will wreck npc ai
+	constexpr f64 TicksPerSecond = 64.0;
+	constexpr f64 TickLength = 1.0 / TicksPerSecond;
+
+	// ticks the world at a fixed rate on its own thread, the rate is kept by clock
+	// a tick runs once the clock has passed the end of the time it simulates, ticks missed during a stall are caught up
+	// back to back, but only up to MaxCatchUpTicks of them so slow ticks can't keep making the thread later
+	class TickThread
+	{
+	public:
+		explicit TickThread(World &world, std::shared_ptr<util::Clock> clock = std::make_shared<util::RealClock>());
+		~TickThread();
+
+		static constexpr u32 MaxCatchUpTicks = 4;
+
+		// the clock time the world has been ticked up to, the newest car poses are for this time
+		[[nodiscard]] inline auto lastTick() const { return m_lastTick.load(std::memory_order_acquire); }
+
+		// how far the clock is past the tick before the one that ended at worldTime, between 0 and 1,
+		// what a snapshot with m_time of worldTime is interpolated by
+		[[nodiscard]] f64 partialTick(f64 worldTime) const;
+
+		// clock time that was skipped instead of ticked because the thread fell too far behind, seconds
+		[[nodiscard]] inline auto droppedTime() const { return m_droppedTime.load(std::memory_order_acquire); }
+
+		[[nodiscard]] inline auto &clock() const { return *m_clock; }
+
+		// how long World::tick took in real time whatever the clock, seconds
+		[[nodiscard]] inline auto &tickTimes() const { return m_tickTimes; }
+		// how late the OS woke the thread after the time the clock asked it for, before the clock spins the rest of the way
+		// to the next tick, seconds, waits short enough to only spin aren't counted
+		[[nodiscard]] inline auto &oversleep() const { return m_oversleep; }
+		// clock time between the starts of consecutive ticks, seconds
+		[[nodiscard]] inline auto &intervals() const { return m_intervals; }
+
+		void startCountingTicks();
+
+		// stops ticking and prints the tick statistics
+		void stop();
+
+		TickThread(const TickThread &) = delete;
+		TickThread(TickThread &&) = delete;
+
+		TickThread &operator=(const TickThread &) = delete;
+		TickThread &operator=(TickThread &&) = delete;
+
+	private:
+		World &m_world;
+		std::shared_ptr<util::Clock> m_clock;
+		std::atomic_bool m_stop { false };
+		std::atomic_bool m_countTicks { false };
+		std::atomic<f64> m_lastTick {};
+		std::atomic<f64> m_droppedTime { 0.0 };
+		std::atomic<f64> m_timeOffset { 0.0 }; // the clock time of World::time() 0, moved on by dropped time
+
+		util::Histogram m_tickTimes, m_oversleep, m_intervals;
+
+		std::thread m_thread;
+
+		void run();
+	};
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "types.h"
+#include <array>
+#include <atomic>
+
+namespace game::util
+{
+	// hands the newest of a stream of values from one writer thread to one reader thread without locks,
+	// the writer always has a buffer of its own to fill and the reader keeps the one it has until it asks again,
+	// so neither ever waits for the other
+	template <typename T>
+	class TripleBuffer
+	{
+	public:
+		TripleBuffer() = default;
+		~TripleBuffer() = default;
+
+		// the buffer being filled, only the writer may touch it, it holds whatever was published two or more times ago
+		[[nodiscard]] inline T &back() { return m_buffers[m_back]; }
+
+		// makes back() the newest and gives the writer a buffer the reader isn't using
+		void publish()
+		{
+			m_back = m_middle.exchange(static_cast<u8>(m_back | Fresh), std::memory_order_acq_rel) & Index;
+		}
+
+		// the newest published buffer, it stays untouched until the next call, only the reader may call this
+		[[nodiscard]] const T &front()
+		{
+			if(m_middle.load(std::memory_order_relaxed) & Fresh) m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & Index;
+
+			return m_buffers[m_front];
+		}
+
+		TripleBuffer(const TripleBuffer &) = delete;
+		TripleBuffer(TripleBuffer &&) = delete;
+
+		TripleBuffer &operator=(const TripleBuffer &) = delete;
+		TripleBuffer &operator=(TripleBuffer &&) = delete;
+
+	private:
+		static constexpr u8 Index = 3;
+		static constexpr u8 Fresh = 4; // set in m_middle when it was published after the reader last took it
+
+		std::array<T, 3> m_buffers {};
+
+		u8 m_back = 0; // only used by the writer
+		u8 m_front = 1; // only used by the reader
+		std::atomic<u8> m_middle { 2 }; // the one being passed between them
+	};
+}
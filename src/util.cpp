@@ -1,94 +1,243 @@
 #include "util.h"
+#include "fixed.h"
 #include <glm/vec2.hpp>
-#include <glm/gtx/rotate_vector.hpp>
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
 #include <array>
 #include <algorithm>
+#include <chrono>
 
 namespace game::util
 {
 	namespace
 	{
-        inline bool sat(const std::array<f64, 4> &proj, f64 len)
+		const auto s_startTime = std::chrono::steady_clock::now();
+
+		template <typename T>
+		inline bool sat(const std::array<T, 4> &proj, T len)
 		{
-			f64 min = std::min(std::min(proj[0], proj[1]), std::min(proj[2], proj[3]));
-			f64 max = std::max(std::max(proj[0], proj[1]), std::max(proj[2], proj[3]));
+			T min = std::min(std::min(proj[0], proj[1]), std::min(proj[2], proj[3]));
+			T max = std::max(std::max(proj[0], proj[1]), std::max(proj[2], proj[3]));
 
-			return min > len || max < 0.0;
+			return min > len || max < T(0);
+		}
+
+		// both boxes have no rotation, so they overlap unless there's a gap on x or y
+		template <typename T>
+		inline bool alignedIntersects(const BasicOrientedBoundingBox<T> &a, const BasicOrientedBoundingBox<T> &b)
+		{
+			using std::abs;
+
+			const auto offset = b.m_position - a.m_position;
+			const glm::vec<2, T> distance { abs(offset.x), abs(offset.y) };
+			const auto extent = (a.m_size + b.m_size) / T(2);
+
+			return distance.x <= extent.x && distance.y <= extent.y;
+		}
+
+		// separating axis theorem with a box that has no rotation, the axes are x and y and the rotated box's edges
+		template <typename T>
+		inline bool alignedIntersects(const typename BasicOrientedBoundingBox<T>::Geometry &aligned, const typename BasicOrientedBoundingBox<T>::Geometry &rotated, glm::vec<2, T> distance)
+		{
+			using std::abs;
+
+			const auto &halfsize = aligned.m_halfsize;
+			const auto &otherHalfsize = rotated.m_halfsize;
+
+			const auto s = rotated.m_sin;
+			const auto c = rotated.m_cos;
+			const auto as = abs(s);
+			const auto ac = abs(c);
+
+			if(abs(distance.x) > halfsize.x + ac * otherHalfsize.x + as * otherHalfsize.y) return false;
+			if(abs(distance.y) > halfsize.y + as * otherHalfsize.x + ac * otherHalfsize.y) return false;
+			if(abs(c * distance.x + s * distance.y) > otherHalfsize.x + ac * halfsize.x + as * halfsize.y) return false;
+			if(abs(c * distance.y - s * distance.x) > otherHalfsize.y + as * halfsize.x + ac * halfsize.y) return false;
+
+			return true;
 		}
 	}
 
+	f64 now()
+	{
+		return std::chrono::duration<f64>(std::chrono::steady_clock::now() - s_startTime).count();
+	}
+
+	i64 steadyNanoseconds(f64 time)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(s_startTime.time_since_epoch()).count() + static_cast<i64>(std::ceil(time * 1e9));
+	}
+
+	//detects whether this obb intersects the other obb
+	template <typename T>
+	bool BasicOrientedBoundingBox<T>::intersects(const BasicOrientedBoundingBox &other) const
+	{
+		// every track hitbox has no rotation, so that case skips the trigonometry
+		if(m_rotation == T(0) && other.m_rotation == T(0)) return alignedIntersects(*this, other);
+
+		const auto &geometry = this->geometry();
+		const auto &otherGeometry = other.geometry();
+
+		const auto distance = other.m_position - m_position;
+
+		// boxes further apart than their bounding circles can't touch, this is most calls
+		const auto radii = geometry.m_radius + otherGeometry.m_radius;
+		if(dot(distance, distance) > radii * radii) return false;
+
+		if(m_rotation == T(0)) return alignedIntersects<T>(geometry, otherGeometry, distance);
+		if(other.m_rotation == T(0)) return alignedIntersects<T>(otherGeometry, geometry, -distance);
+
+		return satIntersects(other);
+	}
+
 	//detects whether this obb intersects the other obb with separating axis theorem
-	bool OrientedBoundingBox::intersects(const OrientedBoundingBox &other) const
+	template <typename T>
+	bool BasicOrientedBoundingBox<T>::satIntersects(const BasicOrientedBoundingBox &other) const
 	{
-	    //stores width, height, rotation and centre (m_position), rotate the size and adds to the position
-
-	    //first object
-		const auto halfsize = m_size / 2.0;
-		const std::array vertices {
-			m_position + glm::rotate(glm::dvec2 { -halfsize.x, -halfsize.y }, m_rotation),
-			m_position + glm::rotate(glm::dvec2 { halfsize.x, -halfsize.y }, m_rotation),
-			m_position + glm::rotate(glm::dvec2 { halfsize.x, halfsize.y }, m_rotation),
-			m_position + glm::rotate(glm::dvec2 { -halfsize.x, halfsize.y }, m_rotation)
-		};
+		const auto &vertices = geometry().m_vertices;
+		const auto &otherVertices = other.geometry().m_vertices;
 
-		//second object which it might be colliding with
-		const auto otherHalfsize = other.m_size / 2.0;
-		const std::array otherVertices {
-			other.m_position + glm::rotate(glm::dvec2 { -otherHalfsize.x, -otherHalfsize.y }, other.m_rotation),
-			other.m_position + glm::rotate(glm::dvec2 { otherHalfsize.x, -otherHalfsize.y }, other.m_rotation),
-			other.m_position + glm::rotate(glm::dvec2 { otherHalfsize.x, otherHalfsize.y }, other.m_rotation),
-			other.m_position + glm::rotate(glm::dvec2 { -otherHalfsize.x, otherHalfsize.y }, other.m_rotation)
+		const auto separated = [](const std::array<Vec, 4> &vertices, const Geometry &geometry, const std::array<Vec, 4> &otherVertices, size_t edge)
+		{
+			const auto &axis = geometry.m_axes[edge];
+			const auto &origin = vertices[edge];
+
+			return sat<T>({
+				dot(otherVertices[0] - origin, axis),
+				dot(otherVertices[1] - origin, axis),
+				dot(otherVertices[2] - origin, axis),
+				dot(otherVertices[3] - origin, axis)
+			}, geometry.m_lengths[edge]);
 		};
 
-		//lab stuff
-		glm::dvec2 axis = vertices[1] - vertices[0];
-		f64 len = glm::length(axis);
+		return !separated(vertices, geometry(), otherVertices, 0) && !separated(vertices, geometry(), otherVertices, 1)
+			&& !separated(otherVertices, other.geometry(), vertices, 0) && !separated(otherVertices, other.geometry(), vertices, 1);
+	}
+
+	// separating axis theorem on the move, each axis gives a window of time when the boxes overlap along it
+	// and the boxes touch when all four windows do
+	template <typename T>
+	T BasicOrientedBoundingBox<T>::sweep(const BasicOrientedBoundingBox &other, Vec displacement) const
+	{
+		using std::abs;
+
+		const auto &geometry = this->geometry();
+		const auto &otherGeometry = other.geometry();
 
-		axis /= len; //divides by the length to get a unit vector
+		const std::array axes { geometry.m_axes[0], geometry.m_axes[1], otherGeometry.m_axes[0], otherGeometry.m_axes[1] };
 
-		if(sat({
-	        glm::dot(otherVertices[0] - vertices[0], axis),
-	        glm::dot(otherVertices[1] - vertices[0], axis),
-	        glm::dot(otherVertices[2] - vertices[0], axis),
-	        glm::dot(otherVertices[3] - vertices[0], axis)
-		}, len)) return false;
+		const auto gapToOther = other.m_position - m_position;
 
-		axis = vertices[2] - vertices[1];
-		len = glm::length(axis);
+		T enter = T(0);
+		T exit = T(1);
 
-		axis /= len;
+		for(const auto &axis : axes)
+		{
+			const auto reach = geometry.m_halfsize.x * abs(dot(geometry.m_axes[0], axis)) + geometry.m_halfsize.y * abs(dot(geometry.m_axes[1], axis))
+							 + otherGeometry.m_halfsize.x * abs(dot(otherGeometry.m_axes[0], axis)) + otherGeometry.m_halfsize.y * abs(dot(otherGeometry.m_axes[1], axis));
 
-		if(sat({
-	        glm::dot(otherVertices[0] - vertices[1], axis),
-	        glm::dot(otherVertices[1] - vertices[1], axis),
-	        glm::dot(otherVertices[2] - vertices[1], axis),
-	        glm::dot(otherVertices[3] - vertices[1], axis)
-		}, len)) return false;
+			const auto gap = dot(gapToOther, axis);
+			const auto speed = dot(displacement, axis);
 
-		axis = otherVertices[1] - otherVertices[0];
-		len = glm::length(axis);
+			if(speed == T(0))
+			{
+				if(abs(gap) > reach) return infinity<T>();
+				continue;
+			}
 
-		axis /= len;
+			const auto first = (gap - reach) / speed;
+			const auto second = (gap + reach) / speed;
 
-		if(sat({
-			glm::dot(vertices[0] - otherVertices[0], axis),
-			glm::dot(vertices[1] - otherVertices[0], axis),
-			glm::dot(vertices[2] - otherVertices[0], axis),
-			glm::dot(vertices[3] - otherVertices[0], axis)
-		}, len)) return false;
+			enter = std::max(enter, std::min(first, second));
+			exit = std::min(exit, std::max(first, second));
 
-		axis = otherVertices[2] - otherVertices[1];
-		len = glm::length(axis);
+			if(enter > exit) return infinity<T>();
+		}
 
-		axis /= len;
+		return enter;
+	}
+
+	// the same four axes as sweep, keeping the one the boxes overlap least along
+	template <typename T>
+	std::optional<BasicContact<T>> BasicOrientedBoundingBox<T>::contact(const BasicOrientedBoundingBox &other) const
+	{
+		using std::abs;
 
-		if(sat({
-			glm::dot(vertices[0] - otherVertices[1], axis),
-			glm::dot(vertices[1] - otherVertices[1], axis),
-			glm::dot(vertices[2] - otherVertices[1], axis),
-			glm::dot(vertices[3] - otherVertices[1], axis)
-		}, len)) return false;
+		const auto &geometry = this->geometry();
+		const auto &otherGeometry = other.geometry();
 
-		return true;
+		const std::array axes { geometry.m_axes[0], geometry.m_axes[1], otherGeometry.m_axes[0], otherGeometry.m_axes[1] };
+
+		const auto gapToOther = other.m_position - m_position;
+
+		BasicContact<T> least { {}, infinity<T>() };
+
+		for(const auto &axis : axes)
+		{
+			const auto reach = geometry.m_halfsize.x * abs(dot(geometry.m_axes[0], axis)) + geometry.m_halfsize.y * abs(dot(geometry.m_axes[1], axis))
+							 + otherGeometry.m_halfsize.x * abs(dot(otherGeometry.m_axes[0], axis)) + otherGeometry.m_halfsize.y * abs(dot(otherGeometry.m_axes[1], axis));
+
+			const auto gap = dot(gapToOther, axis);
+			const auto overlap = reach - abs(gap);
+
+			if(overlap < T(0)) return std::nullopt;
+
+			if(overlap < least.m_depth) least = { gap > T(0) ? -axis : axis, overlap };
+		}
+
+		return least;
+	}
+
+	template <typename T>
+	BasicBounds<T> BasicOrientedBoundingBox<T>::bounds() const
+	{
+		const auto &extent = geometry().m_extent;
+		return { m_position - extent, m_position + extent };
 	}
+
+	template <typename T>
+	const typename BasicOrientedBoundingBox<T>::Geometry &BasicOrientedBoundingBox<T>::updateGeometry() const
+	{
+		using std::sin, std::cos, std::abs;
+
+		//stores width, height, rotation and centre (m_position), rotate the size and adds to the position
+		const auto halfsize = m_size / T(2);
+
+		m_geometry.m_sin = sin(m_rotation);
+		m_geometry.m_cos = cos(m_rotation);
+
+		// the same sums as glm::rotate, without working out the trig again for every vertex
+		const auto rotate = [s = m_geometry.m_sin, c = m_geometry.m_cos](Vec v) { return Vec { v.x * c - v.y * s, v.x * s + v.y * c }; };
+
+		m_geometry.m_vertices = {
+			m_position + rotate({ -halfsize.x, -halfsize.y }),
+			m_position + rotate({ halfsize.x, -halfsize.y }),
+			m_position + rotate({ halfsize.x, halfsize.y }),
+			m_position + rotate({ -halfsize.x, halfsize.y })
+		};
+
+		for(size_t edge = 0; edge < 2; ++edge)
+		{
+			const auto axis = m_geometry.m_vertices[edge + 1] - m_geometry.m_vertices[edge];
+			m_geometry.m_lengths[edge] = length(axis);
+			m_geometry.m_axes[edge] = axis / m_geometry.m_lengths[edge]; //divides by the length to get a unit vector
+		}
+
+		m_geometry.m_halfsize = halfsize;
+		m_geometry.m_radius = length(m_size) / T(2);
+
+		const auto s = abs(m_geometry.m_sin);
+		const auto c = abs(m_geometry.m_cos);
+		m_geometry.m_extent = { (c * m_size.x + s * m_size.y) / T(2), (s * m_size.x + c * m_size.y) / T(2) };
+
+		m_cachedPosition = m_position;
+		m_cachedRotation = m_rotation;
+		m_cachedSize = m_size;
+
+		return m_geometry;
+	}
+
+	template struct BasicOrientedBoundingBox<f32>;
+	template struct BasicOrientedBoundingBox<f64>;
+	template struct BasicOrientedBoundingBox<Fixed>;
 }
@@ -2,8 +2,13 @@
 
 #include "types.h"
 #include <glm/vec2.hpp>
+#include <glm/geometric.hpp>
 #include <cmath>
 #include <algorithm>
+#include <array>
+#include <limits>
+#include <optional>
+#include <type_traits>
 
 namespace game::util
 {
@@ -40,18 +45,120 @@ namespace game::util
 		return v0 + std::clamp(t, 0.0, 1.0) * (v1 - v0);
 	}
 
-	struct OrientedBoundingBox
+	[[nodiscard]] f64 now(); //monotonic time in seconds since the program started
+	[[nodiscard]] i64 steadyNanoseconds(f64 time); //std::chrono::steady_clock's time since its epoch when now() is time, rounded up
+
+	// glm's geometric functions only take floating point, these take any scalar and give glm's results for floating point
+	template <typename T>
+	[[nodiscard]] inline T dot(glm::vec<2, T> a, glm::vec<2, T> b)
+	{
+		if constexpr(std::is_floating_point_v<T>) return glm::dot(a, b);
+		else return a.x * b.x + a.y * b.y;
+	}
+
+	template <typename T>
+	[[nodiscard]] inline T length(glm::vec<2, T> v)
+	{
+		if constexpr(std::is_floating_point_v<T>) return glm::length(v);
+		else
+		{
+			using std::sqrt;
+			return sqrt(dot(v, v));
+		}
+	}
+
+	// infinity, or the largest value for scalars without one
+	template <typename T>
+	[[nodiscard]] constexpr inline T infinity()
+	{
+		if constexpr(std::numeric_limits<T>::has_infinity) return std::numeric_limits<T>::infinity();
+		else return std::numeric_limits<T>::max();
+	}
+
+	// axis-aligned bounds of a shape in world coordinates
+	template <typename T>
+	struct BasicBounds
+	{
+		glm::vec<2, T> m_min { T(0) };
+		glm::vec<2, T> m_max { T(0) };
+	};
+
+	// how two shapes overlap, moving the first by m_normal * m_depth separates them
+	template <typename T>
+	struct BasicContact
+	{
+		glm::vec<2, T> m_normal; // unit length, points away from the other shape
+		T m_depth;
+	};
+
+	// instantiated for f64, which everything in the world uses, f32 for batches that want twice the lanes
+	// and Fixed for cars that have to come out the same everywhere
+	template <typename T>
+	struct BasicOrientedBoundingBox
 	{
-		OrientedBoundingBox() = default;
-		OrientedBoundingBox(glm::dvec2 position, f64 rotation, glm::dvec2 size)
+		using Vec = glm::vec<2, T>;
+
+		// everything the collision tests need that only depends on the box's own position, rotation and size
+		struct Geometry
+		{
+			std::array<Vec, 4> m_vertices;
+			std::array<Vec, 2> m_axes; // unit vectors along the edges from m_vertices[0] and m_vertices[1]
+			std::array<T, 2> m_lengths; // lengths of those edges
+			Vec m_halfsize;
+			Vec m_extent; // half the size of the axis-aligned bounds
+			T m_sin, m_cos;
+			T m_radius; // half the diagonal
+		};
+
+		BasicOrientedBoundingBox() = default;
+		BasicOrientedBoundingBox(Vec position, T rotation, Vec size)
 			: m_position(position),
 			  m_rotation(rotation),
-			  m_size(size) {}
+			  m_size(size)
+		{
+			static_cast<void>(geometry());
+		}
 
-		[[nodiscard]] bool intersects(const OrientedBoundingBox &other) const;
+		[[nodiscard]] bool intersects(const BasicOrientedBoundingBox &other) const;
+		[[nodiscard]] BasicBounds<T> bounds() const;
 
-		glm::dvec2 m_position { 0.0 };
-		f64 m_rotation = 0.0;
-		glm::dvec2 m_size { 1.0, 1.0 };
+		// the fraction of displacement this box can move before it first touches other, 0 if they already touch
+		// or infinity if it never does, the rotation doesn't change during the move
+		[[nodiscard]] T sweep(const BasicOrientedBoundingBox &other, Vec displacement) const;
+
+		// the axis of least overlap between the boxes and how far they overlap along it, nothing if they don't touch
+		[[nodiscard]] std::optional<BasicContact<T>> contact(const BasicOrientedBoundingBox &other) const;
+
+		// cached, and only worked out again after m_position, m_rotation or m_size change
+		// a box nobody is changing can be used from any number of threads
+		[[nodiscard]] inline const Geometry &geometry() const
+		{
+			if(m_position == m_cachedPosition && m_rotation == m_cachedRotation && m_size == m_cachedSize) return m_geometry;
+			return updateGeometry();
+		}
+
+		Vec m_position { T(0) };
+		T m_rotation = T(0);
+		Vec m_size { T(1), T(1) };
+
+	private:
+		// what m_geometry was worked out from, NaN, or the lowest value for scalars without NaN, means it never has been
+		mutable Vec m_cachedPosition { T(0) };
+		mutable T m_cachedRotation = std::numeric_limits<T>::has_quiet_NaN ? std::numeric_limits<T>::quiet_NaN() : std::numeric_limits<T>::lowest();
+		mutable Vec m_cachedSize { T(0) };
+		mutable Geometry m_geometry {};
+
+		[[nodiscard]] bool satIntersects(const BasicOrientedBoundingBox &other) const;
+		const Geometry &updateGeometry() const;
 	};
+
+	using Bounds = BasicBounds<f64>;
+	using Contact = BasicContact<f64>;
+	using OrientedBoundingBox = BasicOrientedBoundingBox<f64>;
+
+	// what the broadphases pad queried bounds by, covers rounding between bounds() and the exact test
+	constexpr f64 QueryPadding = 1e-9;
+
+	extern template struct BasicOrientedBoundingBox<f32>;
+	extern template struct BasicOrientedBoundingBox<f64>;
 }
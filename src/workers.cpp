@@ -0,0 +1,88 @@
+#include "workers.h"
+
+namespace game::util
+{
+	WorkerPool::WorkerPool(u32 threads)
+	{
+		if(threads == 0) threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+		m_threads.reserve(threads - 1);
+
+		for(u32 i = 0; i + 1 < threads; ++i)
+		{
+			m_threads.emplace_back(&WorkerPool::loop, this, i);
+		}
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::unique_lock lock(m_lock);
+			m_stop = true;
+		}
+
+		m_start.notify_all();
+
+		for(auto &thread : m_threads) thread.join();
+	}
+
+	void WorkerPool::run(u32 count, u32 threads, Job job, void *context)
+	{
+		{
+			std::unique_lock lock(m_lock);
+
+			m_job = job;
+			m_context = context;
+			m_count = count;
+			m_chunk = std::max(count / (threads * 4), 1U); // a few chunks each so a thread that falls behind doesn't hold up the rest
+			m_helpers = threads - 1;
+			m_busy = m_helpers;
+			m_next.store(0, std::memory_order_relaxed);
+
+			++m_generation;
+		}
+
+		m_start.notify_all();
+
+		work();
+
+		std::unique_lock lock(m_lock);
+		m_done.wait(lock, [this] { return m_busy == 0; });
+	}
+
+	void WorkerPool::work()
+	{
+		while(true)
+		{
+			const auto begin = m_next.fetch_add(m_chunk, std::memory_order_relaxed);
+			if(begin >= m_count) return;
+
+			m_job(m_context, begin, std::min(m_count, begin + m_chunk));
+		}
+	}
+
+	void WorkerPool::loop(u32 index)
+	{
+		u64 generation = 0;
+
+		while(true)
+		{
+			{
+				std::unique_lock lock(m_lock);
+				m_start.wait(lock, [this, generation] { return m_stop || m_generation != generation; });
+
+				if(m_stop) return;
+
+				generation = m_generation;
+
+				// a small job leaves the threads it doesn't need waiting
+				if(index >= m_helpers) continue;
+			}
+
+			work();
+
+			std::unique_lock lock(m_lock);
+			if(--m_busy == 0) m_done.notify_one();
+		}
+	}
+}
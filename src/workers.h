@@ -0,0 +1,79 @@
+#pragma once
+
+#include "types.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace game::util
+{
+	// threads kept waiting between jobs so a job can be handed out every tick without starting threads each time,
+	// the thread calling forEach works on the job too so a pool of 1 thread runs everything inline
+	class WorkerPool
+	{
+	public:
+		// 0 uses every hardware thread
+		explicit WorkerPool(u32 threads = 1);
+		~WorkerPool();
+
+		// calls work(i) for every i below count, split between at most count / grain threads, and returns once all are done
+		// the calls can be in any order and on any thread, so work(i) shouldn't touch anything work(j) does
+		template <typename Work>
+		void forEach(u32 count, u32 grain, Work &&work)
+		{
+			const auto used = std::min(threads(), count / std::max(grain, 1U));
+
+			if(used <= 1)
+			{
+				for(u32 i = 0; i < count; ++i) work(i);
+				return;
+			}
+
+			run(count, used, [](void *context, u32 begin, u32 end)
+			{
+				auto &work = *static_cast<std::remove_reference_t<Work> *>(context);
+				for(u32 i = begin; i < end; ++i) work(i);
+			}, const_cast<void *>(static_cast<const void *>(&work)));
+		}
+
+		[[nodiscard]] inline u32 threads() const { return static_cast<u32>(m_threads.size()) + 1; }
+
+		WorkerPool(const WorkerPool &) = delete;
+		WorkerPool(WorkerPool &&) = delete;
+
+		WorkerPool &operator=(const WorkerPool &) = delete;
+		WorkerPool &operator=(WorkerPool &&) = delete;
+
+	private:
+		using Job = void (*)(void *context, u32 begin, u32 end);
+
+		std::vector<std::thread> m_threads;
+
+		std::mutex m_lock;
+		std::condition_variable m_start, m_done;
+
+		// the job being run, only changed while no worker is on it
+		Job m_job = nullptr;
+		void *m_context = nullptr;
+		u32 m_count = 0;
+		u32 m_chunk = 1;
+		u32 m_helpers = 0; // how many of m_threads take part in this job
+
+		u64 m_generation = 0; // goes up by one for every job so a worker can tell a new one from the last
+		u32 m_busy = 0; // helpers still on the current job
+		bool m_stop = false;
+
+		std::atomic<u32> m_next { 0 }; // the first index nobody has taken yet
+
+		void run(u32 count, u32 threads, Job job, void *context);
+
+		// takes chunks of the current job until there are none left
+		void work();
+
+		void loop(u32 index);
+	};
+}